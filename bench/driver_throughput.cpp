@@ -0,0 +1,1030 @@
+// Driver SPI efficiency and latency, against the simulated W5500.
+//
+// Host-side benchmark, build from the repository root with e.g.
+//   g++ -O2 -Iinclude bench/driver_throughput.cpp src/*.cpp src/*/*.cpp
+// Add -std=c++20 (or later) to include the coroutine scenario.
+//
+// Each scenario drives the unmodified driver, socket and protocol code over
+// Buses::Simulator, and prints one JSON object per line with the SPI bytes
+// and transactions it cost, per payload byte and per operation, alongside
+// the wall clock time per operation. The SPI figures are deterministic, so
+// any change in them between releases is a real change in driver behaviour.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#if defined(__cpp_impl_coroutine)
+#include <W5500/Async/Scheduler.hpp>
+#include <W5500/Async/Sockets.hpp>
+#include <W5500/Async/Task.hpp>
+#endif
+#include <W5500/Buses/SimulatedDMA.hpp>
+#include <W5500/Buses/Simulator.hpp>
+#include <W5500/FrameRing.hpp>
+#include <W5500/Keepalive.hpp>
+#include <W5500/Pcap.hpp>
+#include <W5500/Protocols/DHCP.hpp>
+#include <W5500/Protocols/DNS.hpp>
+#include <W5500/Protocols/NTP.hpp>
+#include <W5500/Reactor.hpp>
+#include <W5500/RttEstimator.hpp>
+#include <W5500/Socket.hpp>
+#include <W5500/Static/UdpSendQueue.hpp>
+#include <W5500/TcpServer.hpp>
+#include <W5500/W5500.hpp>
+
+namespace {
+
+using W5500::Buses::SimulatedDMA;
+using W5500::Buses::Simulator;
+
+const uint8_t local_ip[4] = {10, 0, 0, 2};
+const uint8_t server_ip[4] = {10, 0, 0, 1};
+uint8_t local_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+const uint8_t tcp_socket = 0;
+const uint8_t udp_socket = 1;
+
+// Accumulates the simulator's counters and the wall clock time spent
+// between begin() and end(), so that set up work can be excluded
+class Scenario {
+  public:
+    Scenario(Simulator &sim, const char *name) : _sim(sim), _name(name) {}
+
+    void begin() {
+        _begin_stats = _sim.stats();
+        _begin_time = std::chrono::steady_clock::now();
+    }
+
+    void end() {
+        const auto now = std::chrono::steady_clock::now();
+        const Simulator::Stats &stats = _sim.stats();
+        _ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   now - _begin_time)
+                   .count();
+        _transactions += stats.transactions - _begin_stats.transactions;
+        _spi_bytes += (stats.header_bytes - _begin_stats.header_bytes) +
+                      (stats.data_bytes - _begin_stats.data_bytes);
+        _network_bytes += (stats.tx_bytes - _begin_stats.tx_bytes) +
+                          (stats.rx_bytes - _begin_stats.rx_bytes);
+    }
+
+    // Print the totals. Payload is the data the operations were moving on
+    // behalf of the application; if it is zero, the traffic the simulated
+    // network saw is used instead.
+    void report(unsigned operations, uint64_t payload_bytes = 0) {
+        if (payload_bytes == 0) {
+            payload_bytes = _network_bytes;
+        }
+        printf("{\"benchmark\": \"driver_throughput\", \"scenario\": \"%s\", "
+               "\"operations\": %u, \"payload_bytes\": %llu, "
+               "\"spi_bytes\": %llu, \"spi_transactions\": %llu, "
+               "\"spi_bytes_per_payload_byte\": %.4f, "
+               "\"spi_transactions_per_payload_byte\": %.6f, "
+               "\"spi_bytes_per_operation\": %.1f, "
+               "\"spi_transactions_per_operation\": %.2f, "
+               "\"ns_per_operation\": %.1f}\n",
+               _name, operations,
+               static_cast<unsigned long long>(payload_bytes),
+               static_cast<unsigned long long>(_spi_bytes),
+               static_cast<unsigned long long>(_transactions),
+               static_cast<double>(_spi_bytes) / payload_bytes,
+               static_cast<double>(_transactions) / payload_bytes,
+               static_cast<double>(_spi_bytes) / operations,
+               static_cast<double>(_transactions) / operations,
+               static_cast<double>(_ns) / operations);
+    }
+
+  private:
+    Simulator &_sim;
+    const char *_name;
+
+    Simulator::Stats _begin_stats;
+    std::chrono::steady_clock::time_point _begin_time;
+
+    uint64_t _ns = 0;
+    uint64_t _transactions = 0;
+    uint64_t _spi_bytes = 0;
+    uint64_t _network_bytes = 0;
+};
+
+// Bring the chip up from reset with a static configuration
+void configure(Simulator &sim, W5500::W5500 &driver) {
+    sim.reset();
+    sim.set_transmit_handler(nullptr, nullptr);
+    driver.reset();
+    driver.set_mac(local_mac);
+    uint8_t ip[4];
+    memcpy(ip, local_ip, 4);
+    driver.set_ip(ip);
+}
+
+void tcp_send(Simulator &sim, W5500::W5500 &driver, size_t chunk,
+              unsigned operations) {
+    configure(sim, driver);
+    W5500::TcpSocket socket(driver, tcp_socket);
+    socket.init();
+    socket.connect(server_ip, 80);
+
+    static uint8_t data[2048];
+    memset(data, 0x5A, sizeof(data));
+
+    char name[32];
+    snprintf(name, sizeof(name), "tcp_send_%zu", chunk);
+    Scenario scenario(sim, name);
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i++) {
+        // Two writes then a flush, as a framed protocol would
+        socket.write(data, chunk / 2);
+        socket.write(data, chunk - chunk / 2);
+        socket.send();
+    }
+    scenario.end();
+    scenario.report(operations, uint64_t(operations) * chunk);
+}
+
+void tcp_read(Simulator &sim, W5500::W5500 &driver, size_t chunk,
+              unsigned operations) {
+    configure(sim, driver);
+    W5500::TcpSocket socket(driver, tcp_socket);
+    socket.init();
+    socket.connect(server_ip, 80);
+
+    static uint8_t data[2048];
+    memset(data, 0xA5, sizeof(data));
+
+    char name[32];
+    snprintf(name, sizeof(name), "tcp_read_%zu", chunk);
+    Scenario scenario(sim, name);
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i++) {
+        sim.inject_tcp(tcp_socket, data, chunk);
+        socket.read(data, chunk);
+    }
+    scenario.end();
+    scenario.report(operations, uint64_t(operations) * chunk);
+}
+
+// Checks what the simulated peer receives against the source
+struct StreamCheck {
+    const uint8_t *source;
+    size_t received = 0;
+    bool mismatch = false;
+};
+
+void check_stream(Simulator &, const Simulator::Packet &packet, void *ctx) {
+    StreamCheck *check = static_cast<StreamCheck *>(ctx);
+    if (memcmp(packet.data, check->source + check->received, packet.size)) {
+        check->mismatch = true;
+    }
+    check->received += packet.size;
+}
+
+// Send 1MiB from memory with send_stream(), polling until it is done. Each
+// operation is one poll_stream().
+void tcp_stream(Simulator &sim, W5500::W5500 &driver) {
+    configure(sim, driver);
+    W5500::TcpSocket socket(driver, tcp_socket);
+    socket.init();
+    socket.connect(server_ip, 80);
+
+    static uint8_t data[1 << 20];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = uint8_t(i * 31 + (i >> 8));
+    }
+    StreamCheck check;
+    check.source = data;
+    sim.set_transmit_handler(check_stream, &check);
+
+    Scenario scenario(sim, "tcp_stream_1048576");
+    scenario.begin();
+    unsigned polls = 0;
+    socket.send_stream(data, sizeof(data));
+    W5500::StreamState state;
+    do {
+        state = socket.poll_stream();
+        polls++;
+    } while (state == W5500::StreamState::SENDING);
+    scenario.end();
+    if (state != W5500::StreamState::DONE || check.mismatch ||
+        check.received != sizeof(data)) {
+        fprintf(stderr, "tcp_stream: sent %zu bytes, %s\n", check.received,
+                check.mismatch ? "corrupted" : "intact");
+    }
+    scenario.report(polls, sizeof(data));
+}
+
+void udp_receive(Simulator &sim, W5500::W5500 &driver, size_t size,
+                 unsigned operations) {
+    configure(sim, driver);
+    W5500::UdpSocket socket(driver, udp_socket);
+    socket.set_source_port(5000);
+    socket.init();
+
+    static uint8_t data[1472];
+    memset(data, 0x3C, sizeof(data));
+
+    char name[32];
+    snprintf(name, sizeof(name), "udp_receive_%zu", size);
+    Scenario scenario(sim, name);
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i++) {
+        sim.inject_udp(udp_socket, server_ip, 5000, data, size);
+        uint8_t source_ip[4];
+        uint16_t source_port;
+        const int packet_size =
+            socket.read_packet_header(source_ip, source_port);
+        socket.read(data, packet_size);
+    }
+    scenario.end();
+    scenario.report(operations, uint64_t(operations) * size);
+}
+
+// Datagrams arriving in bursts, received with recv_batch()
+void udp_receive_batch(Simulator &sim, W5500::W5500 &driver, size_t size,
+                       unsigned operations) {
+    configure(sim, driver);
+    W5500::UdpSocket socket(driver, udp_socket);
+    socket.set_source_port(5000);
+    socket.init();
+
+    static uint8_t data[1472];
+    memset(data, 0x3C, sizeof(data));
+    static uint8_t buffer[2048];
+    W5500::UdpDatagram datagrams[16];
+    const unsigned burst = 16;
+
+    char name[40];
+    snprintf(name, sizeof(name), "udp_receive_batch_%zu", size);
+    Scenario scenario(sim, name);
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i += burst) {
+        for (unsigned j = 0; j < burst; j++) {
+            sim.inject_udp(udp_socket, server_ip, 5000, data, size);
+        }
+        while (socket.recv_batch(buffer, sizeof(buffer), datagrams, 16) > 0) {
+        }
+    }
+    scenario.end();
+    scenario.report(operations, uint64_t(operations) * size);
+}
+
+// Clients connecting to a TcpServer with a pool of four sockets and sending
+// a request, each connection accepted, read and then dropped, re-arming its
+// socket. Each operation is one accepted connection.
+void tcp_server_accept(Simulator &sim, W5500::W5500 &driver,
+                       unsigned operations) {
+    configure(sim, driver);
+    const uint8_t first_socket = 4;
+    const uint8_t socket_count = 4;
+    W5500::TcpServer server(driver, 80);
+    for (uint8_t socket = first_socket; socket < first_socket + socket_count;
+         socket++) {
+        server.add_socket(socket);
+    }
+    server.begin();
+
+    static uint8_t request[64];
+    memset(request, 0x47, sizeof(request));
+
+    Scenario scenario(sim, "tcp_server_accept");
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i++) {
+        const uint8_t client = first_socket + i % socket_count;
+        sim.inject_connection(client, server_ip, uint16_t(40000 + i % 20000));
+        sim.inject_tcp(client, request, sizeof(request));
+        server.poll();
+        const int socket = server.accept();
+        if (socket >= 0) {
+            driver.read(uint8_t(socket), request, sizeof(request));
+            server.release(uint8_t(socket), false);
+        }
+    }
+    scenario.end();
+    if (server.stats().accepted != operations) {
+        fprintf(stderr, "tcp_server_accept: accepted %u of %u\n",
+                server.stats().accepted, operations);
+    }
+    scenario.report(operations, uint64_t(operations) * sizeof(request));
+}
+
+typedef W5500::Static::UdpSendQueue<W5500::W5500> SendQueue;
+
+// Queue datagrams to a rotation of destinations and poll them out. With a
+// single destination the destination registers are written once.
+void udp_send_queue(Simulator &sim, W5500::W5500 &driver, size_t size,
+                    uint8_t destinations, unsigned operations) {
+    configure(sim, driver);
+    W5500::UdpSocket socket(driver, udp_socket);
+    socket.set_source_port(5000);
+    socket.init();
+
+    static uint8_t data[1472];
+    memset(data, 0x6B, sizeof(data));
+    SendQueue::Entry entries[8];
+    SendQueue queue(driver, udp_socket, entries, 8);
+
+    char name[40];
+    snprintf(name, sizeof(name), "udp_send_queue_%zu_x%u", size,
+             destinations);
+    Scenario scenario(sim, name);
+    scenario.begin();
+    unsigned pushed = 0;
+    while (pushed < operations || !queue.empty()) {
+        while (pushed < operations && !queue.full()) {
+            uint8_t ip[4];
+            memcpy(ip, server_ip, 4);
+            ip[3] += pushed % destinations;
+            queue.push(ip, 5000, data, size);
+            pushed++;
+        }
+        queue.poll();
+    }
+    scenario.end();
+    if (queue.stats().sent != operations) {
+        fprintf(stderr, "udp_send_queue: sent %u of %u\n",
+                queue.stats().sent, operations);
+    }
+    scenario.report(operations, uint64_t(operations) * size);
+}
+
+bool discard_sink(const uint8_t *, size_t, void *) { return true; }
+
+// Capture frames in MACRAW mode, either one read_frame() at a time or in
+// bursts into a frame ring, exported as pcap to a sink that discards them
+void macraw_capture(Simulator &sim, W5500::W5500 &driver, size_t size,
+                    bool use_ring, unsigned operations) {
+    configure(sim, driver);
+    W5500::MacRawSocket socket(driver);
+    socket.init();
+
+    static uint8_t frame[1514];
+    memset(frame, 0x6B, sizeof(frame));
+    static uint8_t buffer[1514];
+    static W5500::CapturedFrame frames[16];
+    static uint8_t storage[16 * (1514 + W5500::FrameRing::header_size)];
+    W5500::FrameRing ring(frames, storage, 16, sizeof(storage) / 16);
+    W5500::PcapWriter pcap(discard_sink, nullptr);
+    pcap.write_header(ring.snap_length());
+
+    char name[40];
+    snprintf(name, sizeof(name), "macraw_%s_%zu",
+             use_ring ? "capture" : "read_frame", size);
+    Scenario scenario(sim, name);
+    scenario.begin();
+    unsigned captured = 0;
+    while (captured < operations) {
+        // Let the IC fill up, as it would between polls at line rate
+        unsigned burst = 0;
+        while (captured + burst < operations &&
+               sim.inject_frame(frame, size)) {
+            burst++;
+        }
+        if (use_ring) {
+            while (captured < operations && socket.capture(ring) > 0) {
+                captured += pcap.drain(ring);
+            }
+        } else {
+            while (socket.read_frame(buffer, sizeof(buffer)) > 0) {
+                captured++;
+            }
+        }
+    }
+    scenario.end();
+    scenario.report(operations, uint64_t(operations) * size);
+}
+
+void drain_socket(uint8_t socket, uint8_t, void *ctx) {
+    static_cast<W5500::W5500 *>(ctx)->flush(socket);
+}
+
+// Four UDP sockets, with a datagram arriving on one of them every tenth
+// iteration. Each iteration either checks every socket's interrupt flags, as
+// the protocol update() methods do, or runs an interrupt driven reactor.
+void event_dispatch(Simulator &sim, W5500::W5500 &driver, bool use_reactor,
+                    unsigned operations) {
+    configure(sim, driver);
+    const uint8_t first_socket = 4;
+    const uint8_t socket_count = 4;
+    W5500::Reactor reactor(driver);
+    for (uint8_t socket = first_socket; socket < first_socket + socket_count;
+         socket++) {
+        driver.set_socket_mode(socket, W5500::SocketMode::UDP);
+        driver.set_socket_src_port(socket, 6000 + socket);
+        driver.send_socket_command(
+            socket, W5500::Registers::Socket::CommandValue::OPEN);
+        if (use_reactor) {
+            reactor.attach(
+                socket, drain_socket, &driver,
+                static_cast<uint8_t>(
+                    W5500::Registers::Socket::InterruptFlags::RECV));
+        }
+    }
+    reactor.set_interrupt_driven(true);
+    driver.take_interrupt();
+
+    static uint8_t data[64];
+    memset(data, 0x11, sizeof(data));
+
+    Scenario scenario(sim, use_reactor ? "event_dispatch_reactor"
+                                       : "event_dispatch_polled");
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i++) {
+        if (i % 10 == 0) {
+            sim.inject_udp(first_socket + (i / 10) % socket_count, server_ip,
+                           5000, data, sizeof(data));
+        }
+        if (use_reactor) {
+            reactor.poll();
+            continue;
+        }
+        for (uint8_t socket = first_socket;
+             socket < first_socket + socket_count; socket++) {
+            W5500::Registers::Socket::InterruptRegisterValue flags =
+                driver.get_socket_interrupt_flags(socket);
+            if (flags & W5500::Registers::Socket::InterruptFlags::RECV) {
+                driver.clear_socket_interrupt_flag(
+                    socket, W5500::Registers::Socket::InterruptFlags::RECV);
+                drain_socket(socket, 0, &driver);
+            }
+        }
+    }
+    scenario.end();
+    scenario.report(operations, uint64_t(operations / 10) * sizeof(data));
+}
+
+//// Asynchronous transfers, timed by the simulated DMA bus
+
+// Records the order transactions complete in
+struct CompletionLog {
+    unsigned next = 0;
+    unsigned out_of_order = 0;
+};
+
+void log_completion(W5500::Transaction &, void *ctx) {
+    CompletionLog *log = static_cast<CompletionLog *>(ctx);
+    log->next++;
+}
+
+// Receive a stream of 1460 byte segments over a 20MHz bus, spending
+// process_ns of CPU time on each one. Synchronously, the CPU waits out every
+// transfer; asynchronously, each segment is read by DMA while the previous
+// one is processed. The figures are in simulated time, on the DMA bus's
+// clock, rather than SPI transactions. Every iteration also queues a burst
+// of reads to check that they complete in submission order.
+void dma_receive(bool overlap, unsigned operations) {
+    const size_t chunk = 1460;
+    const uint64_t process_ns = 400000;
+    const unsigned burst = 4;
+
+    Simulator sim;
+    SimulatedDMA bus(sim, 20000000);
+    W5500::W5500 driver(bus);
+    driver.init();
+    driver.reset();
+    W5500::TcpSocket socket(driver, tcp_socket);
+    socket.init();
+    socket.connect(server_ip, 80);
+
+    static uint8_t data[2][2048];
+    memset(data, 0xA5, sizeof(data));
+    W5500::Transaction txn;
+    W5500::Transaction burst_txns[burst];
+    CompletionLog log;
+
+    bus.reset_stats();
+    const uint64_t start_ns = bus.now_ns();
+    for (unsigned i = 0; i < operations; i++) {
+        sim.inject_tcp(tcp_socket, data[0], chunk);
+        if (overlap) {
+            driver.peek_async(tcp_socket, data[i % 2], chunk, txn);
+            bus.advance(process_ns);
+            // Release the data, waiting for the transfer if it's still going
+            driver.read(tcp_socket, nullptr, chunk);
+        } else {
+            driver.read(tcp_socket, data[i % 2], chunk);
+            bus.advance(process_ns);
+        }
+
+        if (i % 100 == 0) {
+            sim.inject_tcp(tcp_socket, data[0], 64);
+            const unsigned first = log.next;
+            for (unsigned j = 0; j < burst; j++) {
+                burst_txns[j].callback = log_completion;
+                burst_txns[j].callback_ctx = &log;
+                driver.peek_async(tcp_socket, data[1], 16, burst_txns[j]);
+            }
+            // Later transactions can't be complete before earlier ones
+            for (unsigned j = 0; j < burst; j++) {
+                bus.advance(1000);
+                for (unsigned k = 0; k < j; k++) {
+                    if (burst_txns[j].complete() &&
+                        !burst_txns[k].complete()) {
+                        log.out_of_order++;
+                    }
+                }
+            }
+            driver.read(tcp_socket, nullptr, 64);
+            if (log.next - first != burst) {
+                log.out_of_order++;
+            }
+        }
+    }
+    const uint64_t elapsed_ns = bus.now_ns() - start_ns;
+
+    const SimulatedDMA::Stats &stats = bus.stats();
+    printf("{\"benchmark\": \"driver_throughput\", \"scenario\": \"%s\", "
+           "\"operations\": %u, \"payload_bytes\": %llu, "
+           "\"simulated_ns_per_operation\": %.1f, "
+           "\"bus_busy_ns_per_operation\": %.1f, "
+           "\"cpu_stall_ns_per_operation\": %.1f, "
+           "\"out_of_order_completions\": %u}\n",
+           overlap ? "dma_receive_overlapped" : "dma_receive_sync", operations,
+           static_cast<unsigned long long>(uint64_t(operations) * chunk),
+           static_cast<double>(elapsed_ns) / operations,
+           static_cast<double>(stats.bus_busy_ns) / operations,
+           static_cast<double>(stats.cpu_stall_ns) / operations,
+           log.out_of_order);
+}
+
+//// Failure detection, timed by the simulator's clock
+
+struct DeadPeer {
+    Simulator *sim;
+    uint64_t detected_ms = 0;
+};
+
+void record_dead_peer(uint8_t, void *ctx) {
+    DeadPeer *dead = static_cast<DeadPeer *>(ctx);
+    dead->detected_ms = dead->sim->now_ms();
+}
+
+// A connected peer vanishes, and a KeepaliveMonitor finds out. Either with
+// the chip's retransmission defaults and a 30s watch, or with a 50ms retry
+// time, 2 retries and a 200ms watch. Reports the simulated time from the
+// loss to the callback.
+void dead_peer(bool tuned) {
+    Simulator sim;
+    W5500::W5500 driver(sim);
+    driver.init();
+    driver.reset();
+    W5500::TcpSocket socket(driver, tcp_socket);
+    socket.init();
+    socket.connect(server_ip, 80);
+
+    DeadPeer dead;
+    dead.sim = &sim;
+    W5500::KeepaliveMonitor monitor(driver);
+    monitor.set_callback(record_dead_peer, &dead);
+    if (tuned) {
+        monitor.set_retransmission(500, 2);
+    }
+    monitor.watch(tcp_socket, tuned ? 200 : 30000);
+
+    // A second of traffic first, so the watch is established
+    for (unsigned i = 0; i < 100; i++) {
+        sim.advance_millis(10);
+        monitor.poll();
+    }
+    sim.inject_peer_loss(tcp_socket);
+    const uint64_t lost_ms = sim.now_ms();
+    while (dead.detected_ms == 0 && sim.now_ms() - lost_ms < 300000) {
+        sim.advance_millis(5);
+        monitor.poll();
+    }
+    if (dead.detected_ms == 0) {
+        fprintf(stderr, "dead_peer: loss not detected\n");
+        return;
+    }
+
+    printf("{\"benchmark\": \"driver_throughput\", \"scenario\": \"%s\", "
+           "\"retransmission_timeout_ms\": %u, \"detection_ms\": %llu, "
+           "\"keepalives\": %u, \"checks\": %u}\n",
+           tuned ? "dead_peer_tuned" : "dead_peer_default",
+           monitor.retransmission_timeout_ms(),
+           static_cast<unsigned long long>(dead.detected_ms - lost_ms),
+           monitor.stats().keepalives, monitor.stats().checks);
+}
+
+// Connections to the gateway, 2ms away, and to a server 80ms away, with RTR
+// and RCR either fixed at a 35ms timeout suited to the gateway, or
+// reprogrammed by an RttEstimator. With the estimator, the server's
+// connection then sends every 200ms while the gateway's sends every 10ms;
+// halfway through, the server's round trip rises to 150ms. Reports how many
+// connections survive, and the estimator's final figures.
+void rtt_profile(bool adaptive) {
+    const uint8_t gateway_ip[4] = {10, 0, 0, 254};
+    const uint8_t far_ip[4] = {192, 0, 2, 1};
+    const uint8_t near_socket = 1;
+    const uint8_t far_socket = 2;
+    const unsigned rounds = 40;
+
+    Simulator sim;
+    sim.set_path_latency(gateway_ip, 2);
+    sim.set_path_latency(far_ip, 80);
+    W5500::W5500 driver(sim);
+    driver.init();
+    driver.reset();
+    W5500::Reactor reactor(driver);
+    W5500::RttEstimator rtt(driver);
+    reactor.attach(near_socket, W5500::RttEstimator::handler, &rtt,
+                   W5500::RttEstimator::events);
+    reactor.attach(far_socket, W5500::RttEstimator::handler, &rtt,
+                   W5500::RttEstimator::events);
+    if (!adaptive) {
+        driver.set_retry_time(50);
+        driver.set_retry_count(2);
+    }
+
+    W5500::TcpSocket near(driver, near_socket);
+    W5500::TcpSocket far(driver, far_socket);
+    near.init();
+    far.init();
+    if (adaptive) {
+        rtt.begin(near_socket, gateway_ip);
+    }
+    near.connect(gateway_ip, 80);
+    if (adaptive) {
+        rtt.begin(far_socket, far_ip);
+    }
+    far.connect(far_ip, 80);
+    for (unsigned i = 0; i < 200; i++) {
+        sim.advance_millis(1);
+        reactor.poll();
+    }
+
+    static uint8_t data[64];
+    memset(data, 0x52, sizeof(data));
+    for (unsigned round = 0; adaptive && round < rounds; round++) {
+        rtt.begin(far_socket, far_ip);
+        far.send(data, sizeof(data));
+        for (unsigned ms = 0; ms < 200; ms++) {
+            if (ms % 10 == 0) {
+                rtt.begin(near_socket, gateway_ip);
+                near.send(data, sizeof(data));
+            }
+            sim.advance_millis(1);
+            reactor.poll();
+        }
+        if (round == rounds / 2) {
+            sim.set_path_latency(far_ip, 150);
+        }
+    }
+
+    unsigned connected = 0;
+    for (uint8_t socket : {near_socket, far_socket}) {
+        connected += driver.get_socket_status(socket) ==
+                     W5500::Registers::Socket::StatusValue::ESTABLISHED;
+    }
+    const W5500::RttEstimator::SocketStats near_stats =
+        rtt.socket_stats(near_socket);
+    const W5500::RttEstimator::SocketStats far_stats =
+        rtt.socket_stats(far_socket);
+    const W5500::RttEstimator::Stats &stats = rtt.stats();
+    printf("{\"benchmark\": \"driver_throughput\", \"scenario\": \"%s\", "
+           "\"connected\": %u, \"near_rto_ms\": %u, \"far_srtt_ms\": %u, "
+           "\"far_rto_ms\": %u, \"ambiguous_samples\": %u, "
+           "\"operations\": %u, \"profile_writes\": %u}\n",
+           adaptive ? "rtt_adaptive" : "rtt_fixed_35ms", connected,
+           near_stats.rto_ms, far_stats.srtt_ms, far_stats.rto_ms,
+           near_stats.ambiguous + far_stats.ambiguous,
+           stats.profile_writes + stats.profile_skips, stats.profile_writes);
+}
+
+#if defined(__cpp_impl_coroutine)
+//// Coroutines
+
+// Answers each request with a response, then closes the connection
+void request_server(Simulator &sim, const Simulator::Packet &packet, void *) {
+    static uint8_t response[512];
+    sim.inject_tcp(packet.socket, response, sizeof(response));
+    sim.inject_disconnect(packet.socket);
+}
+
+struct Exchange {
+    unsigned completed = 0;
+    unsigned failed = 0;
+    size_t received = 0;
+};
+
+W5500::Async::Task send_request(W5500::Async::TcpSocket &socket,
+                                bool &sent) {
+    static const uint8_t request[64] = {0};
+    sent = co_await socket.send_all(request, sizeof(request));
+}
+
+// Connect, send a request from a child task, and read the response until
+// the server closes, as in the README
+W5500::Async::Task exchange(W5500::Async::TcpSocket &socket,
+                            Exchange &result) {
+    bool sent = false;
+    if (!co_await socket.connect(server_ip, 80) ||
+        !co_await send_request(socket, sent) || !sent) {
+        result.failed++;
+        socket.close();
+        co_return;
+    }
+    uint8_t buffer[128];
+    int size;
+    while ((size = co_await socket.recv(buffer)) > 0) {
+        result.received += size;
+    }
+    socket.close();
+    result.completed++;
+}
+
+// Request/response exchanges run by the coroutine scheduler, one at a time,
+// with 1ms to connect and to get each SEND_OK. Each operation is one
+// exchange.
+void async_exchange(Simulator &sim, W5500::W5500 &driver,
+                    unsigned operations) {
+    configure(sim, driver);
+    sim.set_transmit_handler(request_server, nullptr);
+    sim.set_connect_latency(1);
+    sim.set_path_latency(server_ip, 1);
+
+    static W5500::Async::StaticFramePool<512, 2> frame_pool;
+    W5500::Async::FramePool::install(&frame_pool);
+    W5500::Async::Scheduler scheduler(driver);
+    W5500::Async::TcpSocket socket(scheduler, tcp_socket);
+    Exchange result;
+
+    Scenario scenario(sim, "async_exchange");
+    scenario.begin();
+    for (unsigned i = 0; i < operations; i++) {
+        if (!scheduler.spawn(exchange(socket, result))) {
+            break;
+        }
+        while (scheduler.tasks() > 0) {
+            sim.advance_millis(1);
+            scheduler.run_once();
+        }
+    }
+    scenario.end();
+    sim.set_connect_latency(0);
+    sim.set_path_latency(server_ip, 0);
+    W5500::Async::FramePool::install(nullptr);
+    if (result.completed != operations ||
+        result.received != size_t(operations) * 512) {
+        fprintf(stderr,
+                "async_exchange: %u of %u completed, %u failed, frames of "
+                "up to %zu bytes, %u allocations refused\n",
+                result.completed, operations, result.failed,
+                frame_pool.largest_request(), frame_pool.failures());
+    }
+    scenario.report(operations, result.received);
+}
+#endif
+
+//// Simulated servers, answering from the simulator's transmit handler
+
+void put_u32(uint8_t *buffer, uint32_t value) {
+    buffer[0] = value >> 24;
+    buffer[1] = value >> 16;
+    buffer[2] = value >> 8;
+    buffer[3] = value;
+}
+
+void dhcp_server(Simulator &sim, const Simulator::Packet &packet, void *) {
+    if (packet.dest_port != W5500::Protocols::DHCP::dhcp_server_port ||
+        packet.size < 243) {
+        return;
+    }
+    using W5500::Protocols::DHCP::DhcpMessageType;
+    const DhcpMessageType request_type = DhcpMessageType(packet.data[242]);
+    const DhcpMessageType reply_type = request_type == DhcpMessageType::DISCOVER
+                                           ? DhcpMessageType::OFFER
+                                           : DhcpMessageType::ACK;
+
+    uint8_t reply[300];
+    memset(reply, 0, sizeof(reply));
+    reply[0] = 2; // BOOTREPLY
+    reply[1] = 1;
+    reply[2] = 6;
+    memcpy(&reply[4], &packet.data[4], 4); // xid
+    memcpy(&reply[16], local_ip, 4);       // yiaddr
+    memcpy(&reply[28], &packet.data[28], 16);
+    put_u32(&reply[236], W5500::Protocols::DHCP::magic_cookie);
+
+    uint8_t *opt = &reply[240];
+    *opt++ = 53;
+    *opt++ = 1;
+    *opt++ = static_cast<uint8_t>(reply_type);
+    *opt++ = 54;
+    *opt++ = 4;
+    memcpy(opt, server_ip, 4);
+    opt += 4;
+    *opt++ = 1;
+    *opt++ = 4;
+    put_u32(opt, 0xFFFFFF00);
+    opt += 4;
+    *opt++ = 3;
+    *opt++ = 4;
+    memcpy(opt, server_ip, 4);
+    opt += 4;
+    *opt++ = 6;
+    *opt++ = 4;
+    memcpy(opt, server_ip, 4);
+    opt += 4;
+    *opt++ = 51;
+    *opt++ = 4;
+    put_u32(opt, 3600);
+    opt += 4;
+    *opt++ = 0xFF;
+
+    sim.inject_udp(packet.socket, server_ip,
+                   W5500::Protocols::DHCP::dhcp_server_port, reply,
+                   opt - reply);
+}
+
+void dns_server(Simulator &sim, const Simulator::Packet &packet, void *) {
+    if (packet.dest_port != W5500::Protocols::DNS::port || packet.size < 12 ||
+        packet.size > 200) {
+        return;
+    }
+    uint8_t reply[256];
+    memcpy(reply, packet.data, packet.size);
+    reply[2] = 0x81; // Response, recursion desired
+    reply[3] = 0x80; // Recursion available, no error
+    reply[7] = 1;    // One answer
+
+    uint8_t *answer = &reply[packet.size];
+    const uint8_t record[] = {0xC0, 0x0C,            // Name pointer
+                              0x00, 0x01, 0x00, 0x01, // A, IN
+                              0x00, 0x00, 0x0E, 0x10, // TTL
+                              0x00, 0x04,             // RDLENGTH
+                              93,   184,  216,  34};
+    memcpy(answer, record, sizeof(record));
+
+    sim.inject_udp(packet.socket, server_ip, W5500::Protocols::DNS::port, reply,
+                   packet.size + sizeof(record));
+}
+
+void ntp_server(Simulator &sim, const Simulator::Packet &packet, void *) {
+    if (packet.dest_port != W5500::Protocols::NTP::ntp_port) {
+        return;
+    }
+    uint8_t reply[W5500::Protocols::NTP::ntp_packet_size];
+    memset(reply, 0, sizeof(reply));
+    reply[0] = (0b100 << 3) |
+               static_cast<uint8_t>(W5500::Protocols::NTP::Mode::SERVER);
+    reply[1] = 2;
+    reply[2] = 10; // Poll interval
+    put_u32(&reply[40], 3900000000UL);
+    put_u32(&reply[44], 0x80000000UL);
+
+    sim.inject_udp(packet.socket, server_ip, W5500::Protocols::NTP::ntp_port,
+                   reply, sizeof(reply));
+}
+
+bool has_ip(W5500::W5500 &driver) {
+    uint8_t ip[4];
+    driver.get_ip(ip);
+    return memcmp(ip, local_ip, 4) == 0;
+}
+
+// Staging buffer for the write combining variants of the protocol scenarios
+uint8_t tx_buffer[512];
+
+void dhcp_bring_up(Simulator &sim, W5500::W5500 &driver, unsigned operations,
+                   bool combine_writes) {
+    Scenario scenario(sim, combine_writes ? "dhcp_bring_up_write_combining"
+                                          : "dhcp_bring_up");
+    unsigned leased = 0;
+    for (unsigned i = 0; i < operations; i++) {
+        configure(sim, driver);
+        uint8_t no_ip[4] = {0, 0, 0, 0};
+        driver.set_ip(no_ip);
+        sim.set_transmit_handler(dhcp_server, nullptr);
+        W5500::UdpSocket socket(driver, udp_socket);
+        if (combine_writes) {
+            socket.set_tx_buffer(tx_buffer, sizeof(tx_buffer));
+        }
+        W5500::Protocols::DHCP::Client client(driver, socket, "bench");
+
+        scenario.begin();
+        for (int step = 0; step < 100 && !has_ip(driver); step++) {
+            client.update();
+        }
+        scenario.end();
+        leased += has_ip(driver);
+        socket.set_tx_buffer(nullptr, 0);
+    }
+    scenario.report(leased);
+}
+
+void dns_query(Simulator &sim, W5500::W5500 &driver, unsigned operations,
+               bool combine_writes) {
+    configure(sim, driver);
+    sim.set_transmit_handler(dns_server, nullptr);
+    W5500::UdpSocket socket(driver, udp_socket);
+    if (combine_writes) {
+        socket.set_tx_buffer(tx_buffer, sizeof(tx_buffer));
+    }
+
+    Scenario scenario(sim, combine_writes ? "dns_query_write_combining"
+                                          : "dns_query");
+    scenario.begin();
+    unsigned resolved = 0;
+    for (unsigned i = 0; i < operations; i++) {
+        // Fresh cache, so that every query goes to the network
+        W5500::Protocols::DNS::DNSCache cache;
+        W5500::Protocols::DNS::Client client(driver, socket, cache, 10, 0, 0,
+                                             1);
+        client.update();
+
+        uint16_t query_id;
+        uint8_t ip[4];
+        client.query("example.com", &query_id);
+        for (int step = 0; step < 10 && !client.get(query_id, ip); step++) {
+            client.update();
+        }
+        resolved += client.get(query_id, ip);
+    }
+    scenario.end();
+    scenario.report(resolved);
+    socket.set_tx_buffer(nullptr, 0);
+}
+
+void ntp_sync(Simulator &sim, W5500::W5500 &driver, unsigned operations) {
+    configure(sim, driver);
+    sim.set_transmit_handler(ntp_server, nullptr);
+    W5500::UdpSocket socket(driver, udp_socket);
+
+    Scenario scenario(sim, "ntp_sync");
+    scenario.begin();
+    unsigned synced = 0;
+    for (unsigned i = 0; i < operations; i++) {
+        // Far enough along that the client's request interval has passed
+        sim.set_millis(100000 + uint64_t(i) * 100000);
+        W5500::Protocols::NTP::Client client(driver, socket, 10, 0, 0, 1);
+
+        uint64_t now_ms = 0;
+        for (int step = 0; step < 10; step++) {
+            if (client.update(&now_ms)) {
+                synced++;
+                break;
+            }
+        }
+    }
+    scenario.end();
+    scenario.report(synced);
+}
+
+} // namespace
+
+int main() {
+    Simulator sim;
+    W5500::W5500 driver(sim);
+    driver.init();
+
+    const size_t chunks[] = {64, 512, 1460};
+    for (size_t chunk : chunks) {
+        tcp_send(sim, driver, chunk, 20000);
+    }
+    for (size_t chunk : chunks) {
+        tcp_read(sim, driver, chunk, 20000);
+    }
+    tcp_stream(sim, driver);
+    const size_t datagrams[] = {32, 512, 1472};
+    for (size_t size : datagrams) {
+        udp_receive(sim, driver, size, 20000);
+    }
+    for (size_t size : {32, 64}) {
+        udp_receive_batch(sim, driver, size, 20000);
+    }
+    tcp_server_accept(sim, driver, 20000);
+    for (uint8_t destinations : {1, 3}) {
+        udp_send_queue(sim, driver, 64, destinations, 20000);
+    }
+    for (size_t size : {64, 1514}) {
+        for (bool use_ring : {false, true}) {
+            macraw_capture(sim, driver, size, use_ring, 20000);
+        }
+    }
+    for (bool use_reactor : {false, true}) {
+        event_dispatch(sim, driver, use_reactor, 20000);
+    }
+    for (bool overlap : {false, true}) {
+        dma_receive(overlap, 5000);
+    }
+    for (bool tuned : {false, true}) {
+        dead_peer(tuned);
+    }
+    for (bool adaptive : {false, true}) {
+        rtt_profile(adaptive);
+    }
+#if defined(__cpp_impl_coroutine)
+    async_exchange(sim, driver, 5000);
+#endif
+    for (bool combine_writes : {false, true}) {
+        dhcp_bring_up(sim, driver, 2000, combine_writes);
+    }
+    for (bool combine_writes : {false, true}) {
+        dns_query(sim, driver, 5000, combine_writes);
+    }
+    ntp_sync(sim, driver, 5000);
+    return 0;
+}
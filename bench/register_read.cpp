@@ -0,0 +1,90 @@
+// Register read cost: runtime polymorphic vs statically dispatched driver.
+//
+// Host-side benchmark, build from the repository root with e.g.
+//   g++ -O2 -std=c++11 -Iinclude bench/register_read.cpp src/W5500.cpp
+//
+// Both variants run against the same trivial in-memory bus, so the difference
+// in cost is the dispatch overhead of the driver -> bus path itself.
+
+#include <stdio.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <W5500/Static/W5500.hpp>
+#include <W5500/W5500.hpp>
+
+namespace {
+
+const int iterations = 10000000;
+
+// Bus that answers every read with the same byte. Marked final so that the
+// static driver can dispatch to it without going through the vtable.
+class MemoryBus final : public W5500::Bus {
+  public:
+    uint64_t millis() override { return 0; }
+
+    void spi_xfer(uint8_t send, uint8_t *recv) override { *recv = send; }
+
+    using W5500::Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        if (recv == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < count; i++) {
+            recv[i] = (send != nullptr ? send[i] : _value);
+        }
+    }
+
+    void chip_select() override {}
+    void chip_deselect() override {}
+
+  private:
+    uint8_t _value = 0x17;
+};
+
+uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+template <typename DriverT> double cycles_per_read(DriverT &driver) {
+    volatile uint8_t sink = 0;
+    const uint64_t start = cycles();
+    for (int i = 0; i < iterations; i++) {
+        sink = static_cast<uint8_t>(driver.get_socket_status(i & 0x7));
+    }
+    const uint64_t end = cycles();
+    (void)sink;
+    return static_cast<double>(end - start) / iterations;
+}
+
+} // namespace
+
+int main() {
+    MemoryBus bus;
+
+    W5500::W5500 runtime_driver(bus);
+    W5500::Static::W5500<MemoryBus> static_driver(bus);
+
+    // Warm up
+    cycles_per_read(runtime_driver);
+    cycles_per_read(static_driver);
+
+    const double runtime_cost = cycles_per_read(runtime_driver);
+    const double static_cost = cycles_per_read(static_driver);
+
+    printf("{\"benchmark\": \"register_read\", \"iterations\": %d, "
+           "\"runtime_cycles_per_read\": %.2f, "
+           "\"static_cycles_per_read\": %.2f, \"speedup\": %.2f}\n",
+           iterations, runtime_cost, static_cost, runtime_cost / static_cost);
+    return 0;
+}
@@ -0,0 +1,109 @@
+#ifndef _W5500__W5500_ASYNC_FRAMEPOOL_H_
+#define _W5500__W5500_ASYNC_FRAMEPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace W5500 {
+namespace Async {
+
+// Fixed size block allocator for coroutine frames, so that coroutines can be
+// used without a heap. Every frame takes one block, along with a pointer to
+// the pool it came from; a coroutine whose frame is larger than that, or
+// that is started while every block is in use, fails to start (see
+// Task::valid()).
+//
+// Frames are allocated from the installed pool, which must be set before any
+// coroutine is called:
+//
+//     static W5500::Async::StaticFramePool<512, 8> frame_pool;
+//     W5500::Async::FramePool::install(&frame_pool);
+class FramePool {
+  public:
+    FramePool(void *storage, size_t block_size, size_t block_count)
+        : _block_size(round_up(block_size)), _block_count(block_count) {
+        uint8_t *block = static_cast<uint8_t *>(storage);
+        for (size_t i = 0; i < block_count; i++) {
+            release(block + i * _block_size);
+        }
+    }
+
+    void *allocate(size_t size) {
+        if (size > _largest_request) {
+            _largest_request = size;
+        }
+        if (size > _block_size || _free == nullptr) {
+            _failures++;
+            return nullptr;
+        }
+        Block *block = _free;
+        _free = block->next;
+        _free_count--;
+        return block;
+    }
+
+    void deallocate(void *block) {
+        if (block != nullptr) {
+            release(block);
+        }
+    }
+
+    size_t block_size() const { return _block_size; }
+    size_t capacity() const { return _block_count; }
+    size_t free_blocks() const { return _free_count; }
+    // Allocations refused, and the largest asked for, for sizing the pool.
+    // Frame sizes depend on the compiler and optimisation level, so measure
+    // them in the build that ships.
+    uint32_t failures() const { return _failures; }
+    size_t largest_request() const { return _largest_request; }
+
+    // Pool that coroutine frames come from
+    static void install(FramePool *pool) { _installed = pool; }
+    static FramePool *installed() { return _installed; }
+
+    // Block size rounded up to keep every block aligned
+    static constexpr size_t round_up(size_t size) {
+        return (size + alignof(max_align_t) - 1) / alignof(max_align_t) *
+               alignof(max_align_t);
+    }
+
+  private:
+    struct Block {
+        Block *next;
+    };
+
+    const size_t _block_size;
+    const size_t _block_count;
+    Block *_free = nullptr;
+    size_t _free_count = 0;
+    uint32_t _failures = 0;
+    size_t _largest_request = 0;
+
+    inline static FramePool *_installed = nullptr;
+
+    // Disallow copying
+    FramePool(const FramePool &);
+    FramePool &operator=(const FramePool &);
+
+    void release(void *memory) {
+        Block *block = static_cast<Block *>(memory);
+        block->next = _free;
+        _free = block;
+        _free_count++;
+    }
+};
+
+// Frame pool with its own storage
+template <size_t BlockSize, size_t BlockCount>
+class StaticFramePool : public FramePool {
+  public:
+    StaticFramePool() : FramePool(_storage, BlockSize, BlockCount) {}
+
+  private:
+    alignas(max_align_t) uint8_t _storage[round_up(BlockSize) * BlockCount];
+};
+
+} // namespace Async
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_ASYNC_FRAMEPOOL_H_
@@ -0,0 +1,186 @@
+#ifndef _W5500__W5500_ASYNC_SCHEDULER_H_
+#define _W5500__W5500_ASYNC_SCHEDULER_H_
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/Async/Task.hpp>
+#include <W5500/Reactor.hpp>
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+namespace Async {
+
+// Single threaded scheduler for coroutines using the sockets in
+// W5500/Async/Sockets.hpp.
+//
+// A coroutine that awaits a socket operation is parked until an event on
+// that socket gives the operation a chance to make progress; socket events
+// are collected through a Reactor, so run_once() reads SIR to find the
+// sockets with events and nothing else. With the interrupt line connected
+// (set_interrupt_driven(true)), run_once() does no SPI traffic at all until
+// the IC signals an event.
+//
+// The scheduler owns the interrupt flags of every socket it waits on.
+class Scheduler {
+  public:
+    static const size_t max_tasks = 8;
+    static const size_t max_waits = 16;
+
+    // Advance an operation with the flags that fired on its socket (0 when
+    // it is first awaited). Returns true once the operation is complete.
+    typedef bool (*Step)(void *operation, uint8_t flags);
+
+    explicit Scheduler(W5500 &driver) : _driver(driver), _reactor(driver) {}
+
+    W5500 &driver() { return _driver; }
+
+    void set_interrupt_driven(bool interrupt_driven) {
+        _reactor.set_interrupt_driven(interrupt_driven);
+    }
+
+    // Start a task, which runs until its first suspension. Returns false if
+    // the task could not be allocated, or too many are running.
+    bool spawn(Task task) {
+        if (!task.valid()) {
+            return false;
+        }
+        for (Task::Handle &slot : _tasks) {
+            if (!slot) {
+                slot = task.release();
+                slot.resume();
+                reap();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Handle socket events, and resume the coroutines whose operations
+    // completed. Returns the number resumed.
+    int run_once() {
+        _reactor.poll();
+        int resumed = 0;
+        for (Wait &wait : _waits) {
+            if (!wait.active || wait.flags == 0) {
+                continue;
+            }
+            const uint8_t flags = wait.flags;
+            wait.flags = 0;
+            if (wait.step(wait.operation, flags)) {
+                // The coroutine may wait again, possibly in this slot
+                wait.active = false;
+                wait.handle.resume();
+                resumed++;
+            }
+        }
+        reap();
+        return resumed;
+    }
+
+    // Tasks that have not yet finished
+    size_t tasks() const {
+        size_t count = 0;
+        for (const Task::Handle &slot : _tasks) {
+            count += slot ? 1 : 0;
+        }
+        return count;
+    }
+
+    // Park a coroutine until step() reports its operation complete. Returns
+    // false if there are too many waits already.
+    bool wait(std::coroutine_handle<> handle, uint8_t socket, Step step,
+              void *operation) {
+        for (Wait &wait : _waits) {
+            if (!wait.active) {
+                if (!(_attached & (1 << socket))) {
+                    _reactor.attach(socket, on_event, this);
+                    _attached |= 1 << socket;
+                }
+                wait.handle = handle;
+                wait.step = step;
+                wait.operation = operation;
+                wait.socket = socket;
+                wait.flags = 0;
+                wait.active = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    struct Wait {
+        std::coroutine_handle<> handle;
+        Step step = nullptr;
+        void *operation = nullptr;
+        uint8_t socket = 0;
+        // Flags seen since the operation was last stepped
+        uint8_t flags = 0;
+        bool active = false;
+    };
+
+    W5500 &_driver;
+    Reactor _reactor;
+    Task::Handle _tasks[max_tasks];
+    Wait _waits[max_waits];
+    // Sockets registered with the reactor
+    uint8_t _attached = 0;
+
+    // Disallow copying
+    Scheduler(const Scheduler &);
+    Scheduler &operator=(const Scheduler &);
+
+    static void on_event(uint8_t socket, uint8_t flags, void *ctx) {
+        Scheduler *scheduler = static_cast<Scheduler *>(ctx);
+        for (Wait &wait : scheduler->_waits) {
+            if (wait.active && wait.socket == socket) {
+                wait.flags |= flags;
+            }
+        }
+    }
+
+    // Free the frames of finished tasks
+    void reap() {
+        for (Task::Handle &slot : _tasks) {
+            if (slot && slot.done()) {
+                slot.destroy();
+                slot = nullptr;
+            }
+        }
+    }
+};
+
+// Base for awaitable socket operations. Op provides step(flags), returning
+// true when complete, and fail(), called if it can't be parked.
+template <typename Op> class Operation {
+  public:
+    bool await_ready() { return static_cast<Op *>(this)->step(0); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        Op *op = static_cast<Op *>(this);
+        if (!_scheduler.wait(handle, _sockfd, advance, op)) {
+            op->fail();
+            return false;
+        }
+        return true;
+    }
+
+  protected:
+    Scheduler &_scheduler;
+    const uint8_t _sockfd;
+
+    Operation(Scheduler &scheduler, uint8_t sockfd)
+        : _scheduler(scheduler), _sockfd(sockfd) {}
+
+  private:
+    static bool advance(void *op, uint8_t flags) {
+        return static_cast<Op *>(op)->step(flags);
+    }
+};
+
+} // namespace Async
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_ASYNC_SCHEDULER_H_
@@ -0,0 +1,319 @@
+#ifndef _W5500__W5500_ASYNC_SOCKETS_H_
+#define _W5500__W5500_ASYNC_SOCKETS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <W5500/Async/Scheduler.hpp>
+#include <W5500/Registers.hpp>
+#include <W5500/Socket.hpp>
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+namespace Async {
+
+// TCP socket with awaitable operations, for use from a Task:
+//
+//     W5500::Async::Task fetch(W5500::Async::TcpSocket &socket) {
+//         if (!co_await socket.connect(server_ip, 80)) {
+//             co_return;
+//         }
+//         co_await socket.send_all(request, sizeof(request));
+//         uint8_t buffer[256];
+//         int size;
+//         while ((size = co_await socket.recv(buffer)) > 0) {
+//             handle_response(buffer, size);
+//         }
+//         socket.close();
+//     }
+class TcpSocket {
+  public:
+    // Open the socket and connect. Completes with true once established,
+    // or false if the connection failed.
+    class Connect : public Operation<Connect> {
+      public:
+        Connect(Scheduler &scheduler, ::W5500::TcpSocket &socket,
+                uint8_t sockfd, const uint8_t ip[4], uint16_t port)
+            : Operation(scheduler, sockfd), _socket(socket), _port(port) {
+            memcpy(_ip, ip, 4);
+        }
+
+        bool step(uint8_t) {
+            if (!_started) {
+                _started = true;
+                _socket.init();
+                _socket.connect(_ip, _port);
+            }
+            const Registers::Socket::StatusValue status =
+                _scheduler.driver().get_socket_status(_sockfd);
+            _connected =
+                status == Registers::Socket::StatusValue::ESTABLISHED ||
+                status == Registers::Socket::StatusValue::CLOSE_WAIT;
+            return _connected ||
+                   status == Registers::Socket::StatusValue::CLOSED;
+        }
+        void fail() { _connected = false; }
+        bool await_resume() { return _connected; }
+
+      private:
+        ::W5500::TcpSocket &_socket;
+        uint8_t _ip[4];
+        const uint16_t _port;
+        bool _started = false;
+        bool _connected = false;
+    };
+
+    // Receive whatever data is available, once there is some. Completes
+    // with the number of bytes read, 0 if the connection has closed, or -1
+    // on error.
+    class Recv : public Operation<Recv> {
+      public:
+        Recv(Scheduler &scheduler, ::W5500::TcpSocket &socket, uint8_t sockfd,
+             uint8_t *buffer, size_t size)
+            : Operation(scheduler, sockfd), _socket(socket), _buffer(buffer),
+              _size(size) {}
+
+        bool step(uint8_t) {
+            const size_t available = _socket.rx_byte_count();
+            if (available > 0) {
+                _result = _socket.read(_buffer,
+                                       available < _size ? available : _size);
+                return true;
+            }
+            if (!_socket.connected()) {
+                _result = 0;
+                return true;
+            }
+            return false;
+        }
+        void fail() { _result = -1; }
+        int await_resume() { return _result; }
+
+      private:
+        ::W5500::TcpSocket &_socket;
+        uint8_t *const _buffer;
+        const size_t _size;
+        int _result = -1;
+    };
+
+    // Send all of a buffer, a TX buffer's worth at a time, waiting for each
+    // SEND to complete. Completes with true once everything has been sent.
+    class SendAll : public Operation<SendAll> {
+      public:
+        SendAll(Scheduler &scheduler, ::W5500::TcpSocket &socket,
+                uint8_t sockfd, const uint8_t *buffer, size_t size)
+            : Operation(scheduler, sockfd), _socket(socket), _data(buffer),
+              _remaining(size) {}
+
+        bool step(uint8_t flags) {
+            using Registers::Socket::InterruptFlags;
+            W5500 &driver = _scheduler.driver();
+            if (!_started) {
+                _started = true;
+                if (!_socket.connected()) {
+                    _failed = true;
+                    return true;
+                }
+                // Don't mistake an earlier send's SEND_OK for ours
+                driver.clear_socket_interrupt_flag(_sockfd,
+                                                   InterruptFlags::SEND_OK);
+            }
+            if (flags & static_cast<uint8_t>(InterruptFlags::TIMEOUT)) {
+                _failed = true;
+                return true;
+            }
+            if (flags & static_cast<uint8_t>(InterruptFlags::SEND_OK)) {
+                _in_flight = false;
+            }
+            if (_in_flight) {
+                return false;
+            }
+            if (_remaining == 0) {
+                return true;
+            }
+
+            const size_t free = driver.get_tx_free_size(_sockfd);
+            const size_t size = free < _remaining ? free : _remaining;
+            if (size > 0) {
+                _socket.send(_data, size);
+                _data += size;
+                _remaining -= size;
+                _in_flight = true;
+            }
+            return false;
+        }
+        void fail() { _failed = true; }
+        bool await_resume() { return !_failed && _remaining == 0; }
+
+      private:
+        ::W5500::TcpSocket &_socket;
+        const uint8_t *_data;
+        size_t _remaining;
+        bool _started = false;
+        bool _in_flight = false;
+        bool _failed = false;
+    };
+
+    TcpSocket(Scheduler &scheduler, uint8_t sockfd)
+        : _scheduler(scheduler), _sockfd(sockfd),
+          _socket(scheduler.driver(), sockfd) {}
+
+    Connect connect(const uint8_t ip[4], uint16_t port) {
+        return Connect(_scheduler, _socket, _sockfd, ip, port);
+    }
+    Recv recv(uint8_t *buffer, size_t size) {
+        return Recv(_scheduler, _socket, _sockfd, buffer, size);
+    }
+    template <size_t N> Recv recv(uint8_t (&buffer)[N]) {
+        return recv(buffer, N);
+    }
+    SendAll send_all(const uint8_t *buffer, size_t size) {
+        return SendAll(_scheduler, _socket, _sockfd, buffer, size);
+    }
+    void close() { _socket.close(); }
+
+    // The underlying socket, for anything that doesn't need to wait
+    ::W5500::TcpSocket &socket() { return _socket; }
+
+  private:
+    Scheduler &_scheduler;
+    const uint8_t _sockfd;
+    ::W5500::TcpSocket _socket;
+};
+
+// UDP socket with awaitable operations
+class UdpSocket {
+  public:
+    // Receive the next datagram. Completes with the datagram, its data in
+    // the buffer given; a datagram larger than the buffer is truncated.
+    class RecvFrom : public Operation<RecvFrom> {
+      public:
+        RecvFrom(Scheduler &scheduler, ::W5500::UdpSocket &socket,
+                 uint8_t sockfd, uint8_t *buffer, size_t size)
+            : Operation(scheduler, sockfd), _socket(socket), _buffer(buffer),
+              _size(size) {
+            _datagram.data = nullptr;
+            _datagram.size = 0;
+        }
+
+        bool step(uint8_t) {
+            if (_socket.remaining_bytes_in_packet() > 0) {
+                _socket.skip_to_packet_end();
+            }
+            const int size = _socket.read_packet_header(_datagram.source_ip,
+                                                        _datagram.source_port);
+            if (size < 0) {
+                return false;
+            }
+            const size_t kept = size_t(size) < _size ? size_t(size) : _size;
+            _socket.read(_buffer, kept);
+            _socket.skip_to_packet_end();
+            _datagram.data = _buffer;
+            _datagram.size = kept;
+            return true;
+        }
+        void fail() {}
+        UdpDatagram await_resume() { return _datagram; }
+
+      private:
+        ::W5500::UdpSocket &_socket;
+        uint8_t *const _buffer;
+        const size_t _size;
+        UdpDatagram _datagram;
+    };
+
+    // Send a datagram. Completes with true once it has been sent, or false
+    // if the destination could not be resolved.
+    class SendTo : public Operation<SendTo> {
+      public:
+        SendTo(Scheduler &scheduler, ::W5500::UdpSocket &socket,
+               uint8_t sockfd, const uint8_t ip[4], uint16_t port,
+               const uint8_t *data, size_t size)
+            : Operation(scheduler, sockfd), _socket(socket), _port(port),
+              _data(data), _size(size) {
+            memcpy(_ip, ip, 4);
+        }
+
+        bool step(uint8_t flags) {
+            using Registers::Socket::InterruptFlags;
+            if (!_started) {
+                _started = true;
+                W5500 &driver = _scheduler.driver();
+                driver.clear_socket_interrupt_flags(
+                    _sockfd, static_cast<uint8_t>(InterruptFlags::SEND_OK) |
+                                 static_cast<uint8_t>(InterruptFlags::TIMEOUT));
+                _socket.set_dest_ip(_ip);
+                _socket.set_dest_port(_port);
+                _socket.send(_data, _size);
+                return false;
+            }
+            if (flags & static_cast<uint8_t>(InterruptFlags::SEND_OK)) {
+                _sent = true;
+                return true;
+            }
+            return (flags & static_cast<uint8_t>(InterruptFlags::TIMEOUT)) != 0;
+        }
+        // The datagram has already gone to the IC by the time the wait is
+        // refused, so wait for its outcome here rather than guess at it
+        void fail() {
+            using Registers::Socket::InterruptFlags;
+            W5500 &driver = _scheduler.driver();
+            for (;;) {
+                Registers::Socket::InterruptRegisterValue flags =
+                    driver.get_socket_interrupt_flags(_sockfd);
+                if (flags & InterruptFlags::SEND_OK) {
+                    _sent = true;
+                    break;
+                }
+                if (flags & InterruptFlags::TIMEOUT) {
+                    _sent = false;
+                    break;
+                }
+            }
+        }
+        bool await_resume() { return _sent; }
+
+      private:
+        ::W5500::UdpSocket &_socket;
+        uint8_t _ip[4];
+        const uint16_t _port;
+        const uint8_t *const _data;
+        const size_t _size;
+        bool _started = false;
+        bool _sent = false;
+    };
+
+    UdpSocket(Scheduler &scheduler, uint8_t sockfd)
+        : _scheduler(scheduler), _sockfd(sockfd),
+          _socket(scheduler.driver(), sockfd) {}
+
+    bool init(uint16_t port) {
+        _socket.set_source_port(port);
+        return _socket.init();
+    }
+
+    RecvFrom recv_from(uint8_t *buffer, size_t size) {
+        return RecvFrom(_scheduler, _socket, _sockfd, buffer, size);
+    }
+    template <size_t N> RecvFrom recv_from(uint8_t (&buffer)[N]) {
+        return recv_from(buffer, N);
+    }
+    SendTo send_to(const uint8_t ip[4], uint16_t port, const uint8_t *data,
+                   size_t size) {
+        return SendTo(_scheduler, _socket, _sockfd, ip, port, data, size);
+    }
+    void close() { _socket.close(); }
+
+    ::W5500::UdpSocket &socket() { return _socket; }
+
+  private:
+    Scheduler &_scheduler;
+    const uint8_t _sockfd;
+    ::W5500::UdpSocket _socket;
+};
+
+} // namespace Async
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_ASYNC_SOCKETS_H_
@@ -0,0 +1,146 @@
+#ifndef _W5500__W5500_ASYNC_TASK_H_
+#define _W5500__W5500_ASYNC_TASK_H_
+
+#if !defined(__cpp_impl_coroutine)
+#error "W5500/Async requires C++20 coroutine support"
+#endif
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/Async/FramePool.hpp>
+
+namespace W5500 {
+namespace Async {
+
+// Coroutine returning nothing. A task does not run until it is either given
+// to Scheduler::spawn(), or awaited from another task, in which case the
+// awaiting task carries on once it finishes.
+//
+// Frames are allocated from the installed FramePool. If there is no room,
+// the task is returned empty (valid() is false) and never runs; spawn()
+// returns false, and co_await on it returns false at once:
+//
+//     if (!co_await child()) {
+//         // Out of frames
+//     }
+class Task {
+  public:
+    struct promise_type {
+        // Task waiting on this one, if any
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        static Task get_return_object_on_allocation_failure() {
+            return Task();
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Hand control back to the awaiting task, or to the scheduler
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<>
+            await_suspend(std::coroutine_handle<promise_type> task) noexcept {
+                if (task.promise().continuation) {
+                    return task.promise().continuation;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() {}
+
+        // Each frame is followed by the pool it came from, so that it goes
+        // back there even if another pool has been installed since
+        static void *operator new(size_t size) noexcept {
+            FramePool *pool = FramePool::installed();
+            if (pool == nullptr) {
+                return nullptr;
+            }
+            void *frame =
+                pool->allocate(owner_offset(size) + sizeof(FramePool *));
+            if (frame != nullptr) {
+                *owner(frame, size) = pool;
+            }
+            return frame;
+        }
+        static void operator delete(void *frame, size_t size) noexcept {
+            (*owner(frame, size))->deallocate(frame);
+        }
+
+      private:
+        static constexpr size_t owner_offset(size_t size) {
+            return (size + alignof(FramePool *) - 1) / alignof(FramePool *) *
+                   alignof(FramePool *);
+        }
+        static FramePool **owner(void *frame, size_t size) {
+            uint8_t *end = static_cast<uint8_t *>(frame) + owner_offset(size);
+            return reinterpret_cast<FramePool **>(end);
+        }
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Task() {}
+    Task(Task &&other) : _handle(other._handle) { other._handle = nullptr; }
+    Task &operator=(Task &&other) {
+        if (this != &other) {
+            destroy();
+            _handle = other._handle;
+            other._handle = nullptr;
+        }
+        return *this;
+    }
+    ~Task() { destroy(); }
+
+    // False if the frame could not be allocated
+    bool valid() const { return bool(_handle); }
+    bool done() const { return !_handle || _handle.done(); }
+
+    // Give up ownership of the coroutine
+    Handle release() {
+        Handle handle = _handle;
+        _handle = nullptr;
+        return handle;
+    }
+
+    //// Awaiting a task runs it to completion
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+    // False if the task could not run at all
+    bool await_resume() noexcept { return valid(); }
+
+  private:
+    Handle _handle;
+
+    explicit Task(Handle handle) : _handle(handle) {}
+
+    // Disallow copying
+    Task(const Task &);
+    Task &operator=(const Task &);
+
+    void destroy() {
+        if (_handle) {
+            _handle.destroy();
+            _handle = nullptr;
+        }
+    }
+};
+
+} // namespace Async
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_ASYNC_TASK_H_
@@ -0,0 +1,207 @@
+#ifndef _W5500__W5500_BUFFERPLANNER_H_
+#define _W5500__W5500_BUFFERPLANNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/Registers.hpp>
+
+namespace W5500 {
+
+// Plans how the IC's 16KB of TX and 16KB of RX buffer memory is divided
+// between sockets, from what each socket is used for.
+//
+// Every socket in use gets a minimum allocation for its role. What is left
+// is then handed out by repeatedly doubling the buffer of the socket with
+// the highest expected throughput per KB it already has, so that bulk
+// transfer sockets end up with large buffers and request/response sockets
+// like DHCP and NTP stay at 1KB.
+//
+// The IC places socket buffers back to back in socket order, so changing
+// the size of one socket moves the buffers of every socket after it.
+// apply() therefore refuses to change anything while an affected socket is
+// open, unless forced; rebalance at a point where those sockets are closed.
+class BufferPlanner {
+  public:
+    enum class Role : uint8_t {
+        // Not used, gets no buffer memory
+        UNUSED,
+        // Open, but with little or no traffic (e.g. DHCP holding a lease)
+        IDLE,
+        // Small request/response exchanges (DNS, NTP, DHCP)
+        CONTROL,
+        // Mostly sending, mostly receiving, or both
+        BULK_TX,
+        BULK_RX,
+        BULK,
+    };
+
+    enum class Result : uint8_t {
+        APPLIED,
+        // The minimum allocations don't fit in the buffer memory
+        OVER_BUDGET,
+        // A socket that would be moved or resized is open
+        SOCKET_OPEN,
+    };
+
+    static const uint8_t budget_kb = 16;
+
+    // Declare a socket's use. Expected throughput is in bytes per second,
+    // and only matters relative to the other sockets; if it is left at 0,
+    // bulk directions are weighted equally.
+    void set_socket(uint8_t socket, Role role, uint32_t tx_rate = 0,
+                    uint32_t rx_rate = 0) {
+        _demand[socket].role = role;
+        _demand[socket].tx_rate = tx_rate;
+        _demand[socket].rx_rate = rx_rate;
+    }
+
+    // Work out sizes for every socket. Returns false if the minimum
+    // allocations don't fit.
+    bool plan() {
+        return plan_direction(true, _tx_kb) && plan_direction(false, _rx_kb);
+    }
+
+    Registers::Socket::BufferSize tx_size(uint8_t socket) const {
+        return Registers::Socket::BufferSize(_tx_kb[socket]);
+    }
+    Registers::Socket::BufferSize rx_size(uint8_t socket) const {
+        return Registers::Socket::BufferSize(_rx_kb[socket]);
+    }
+
+    // Check that a set of sizes is valid and fits in the buffer memory
+    static bool validate(const Registers::Socket::BufferSize tx[max_sockets],
+                         const Registers::Socket::BufferSize rx[max_sockets]) {
+        return fits(tx) && fits(rx);
+    }
+
+    // Plan, and write any sizes that changed to the IC
+    template <typename DriverT>
+    Result apply(DriverT &driver, bool force = false) {
+        if (!plan()) {
+            return Result::OVER_BUDGET;
+        }
+
+        uint8_t current_tx[max_sockets];
+        uint8_t current_rx[max_sockets];
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            current_tx[socket] =
+                static_cast<uint8_t>(driver.get_socket_tx_buffer_size(socket));
+            current_rx[socket] =
+                static_cast<uint8_t>(driver.get_socket_rx_buffer_size(socket));
+        }
+
+        // Once one socket's buffer changes, everything after it moves
+        if (!force) {
+            bool moved = false;
+            for (uint8_t socket = 0; socket < max_sockets; socket++) {
+                moved = moved || current_tx[socket] != _tx_kb[socket] ||
+                        current_rx[socket] != _rx_kb[socket];
+                if (moved && (current_tx[socket] > 0 ||
+                              current_rx[socket] > 0 || _tx_kb[socket] > 0 ||
+                              _rx_kb[socket] > 0) &&
+                    driver.get_socket_status(socket) !=
+                        Registers::Socket::StatusValue::CLOSED) {
+                    return Result::SOCKET_OPEN;
+                }
+            }
+        }
+
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            if (current_tx[socket] != _tx_kb[socket]) {
+                driver.set_socket_tx_buffer_size(socket, tx_size(socket));
+            }
+            if (current_rx[socket] != _rx_kb[socket]) {
+                driver.set_socket_rx_buffer_size(socket, rx_size(socket));
+            }
+        }
+        return Result::APPLIED;
+    }
+
+  private:
+    struct Demand {
+        Role role = Role::UNUSED;
+        uint32_t tx_rate = 0;
+        uint32_t rx_rate = 0;
+    };
+    Demand _demand[max_sockets];
+
+    // Planned sizes in KB, which is also the register encoding
+    uint8_t _tx_kb[max_sockets] = {};
+    uint8_t _rx_kb[max_sockets] = {};
+
+    static bool fits(const Registers::Socket::BufferSize sizes[max_sockets]) {
+        unsigned total = 0;
+        for (size_t socket = 0; socket < max_sockets; socket++) {
+            const uint8_t kb = static_cast<uint8_t>(sizes[socket]);
+            // Sizes must be 0 or a power of two up to 16
+            if (kb > budget_kb || (kb & (kb - 1)) != 0) {
+                return false;
+            }
+            total += kb;
+        }
+        return total <= budget_kb;
+    }
+
+    static bool is_bulk(Role role, bool tx) {
+        return role == Role::BULK ||
+               role == (tx ? Role::BULK_TX : Role::BULK_RX);
+    }
+
+    // Smallest buffer a socket is given in one direction
+    static uint8_t minimum_kb(Role role, bool tx) {
+        if (role == Role::UNUSED) {
+            return 0;
+        }
+        // Room for a couple of full segments in flight
+        return is_bulk(role, tx) ? 2 : 1;
+    }
+
+    // Relative demand for buffer space. Only bulk directions grow.
+    uint32_t weight(uint8_t socket, bool tx) const {
+        const Demand &demand = _demand[socket];
+        if (!is_bulk(demand.role, tx)) {
+            return 0;
+        }
+        const uint32_t rate = tx ? demand.tx_rate : demand.rx_rate;
+        return rate > 0 ? rate : 1;
+    }
+
+    bool plan_direction(bool tx, uint8_t kb[max_sockets]) {
+        unsigned used = 0;
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            kb[socket] = minimum_kb(_demand[socket].role, tx);
+            used += kb[socket];
+        }
+        if (used > budget_kb) {
+            return false;
+        }
+
+        // Keep doubling the socket with the most demand per KB it already
+        // has, skipping any whose doubling no longer fits
+        for (;;) {
+            int best = -1;
+            for (uint8_t socket = 0; socket < max_sockets; socket++) {
+                const uint32_t w = weight(socket, tx);
+                if (w == 0 || kb[socket] >= budget_kb ||
+                    used + kb[socket] > budget_kb) {
+                    continue;
+                }
+                // Compare w / kb without dividing
+                if (best < 0 || uint64_t(w) * kb[best] >
+                                    uint64_t(weight(best, tx)) * kb[socket]) {
+                    best = socket;
+                }
+            }
+            if (best < 0) {
+                return true;
+            }
+            used += kb[best];
+            kb[best] *= 2;
+        }
+    }
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUFFERPLANNER_H_
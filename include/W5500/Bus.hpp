@@ -1,11 +1,61 @@
 #ifndef _W5500__W5500_BUS_H_
 #define _W5500__W5500_BUS_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace W5500 {
 
 class W5500;
+class Bus;
+namespace Static {
+template <typename BusT> class W5500;
+} // namespace Static
+
+// One segment of a scatter-gather transfer. Same semantics as the arguments
+// to Bus::spi_xfer: a null send pointer sends zeros, and a null recv pointer
+// discards the received data.
+struct Segment {
+    const uint8_t *send;
+    uint8_t *recv;
+    size_t count;
+};
+
+// Asynchronous SPI transaction.
+// A transaction is a list of segments, transferred back to back under one
+// chip select. Both the transaction and any buffers it points to must remain
+// valid until it has completed.
+class Transaction {
+  public:
+    typedef void (*Callback)(Transaction &txn, void *ctx);
+
+    // Segments to transfer
+    const Segment *segments = nullptr;
+    size_t segment_count = 0;
+
+    // Storage for transactions built by the driver, which are always a
+    // command header followed by a data phase.
+    uint8_t header[3];
+    Segment frame[2];
+
+    // Optional completion callback. Depending on the bus, this may be
+    // called from interrupt context.
+    Callback callback = nullptr;
+    void *callback_ctx = nullptr;
+
+    // Poll handle
+    bool pending() const { return _state == State::PENDING; }
+    bool complete() const { return _state == State::COMPLETE; }
+
+  private:
+    enum class State : uint8_t { IDLE, PENDING, COMPLETE };
+    volatile State _state = State::IDLE;
+
+    // Intrusive queue link, for buses that queue transactions
+    Transaction *_next = nullptr;
+
+    friend class Bus;
+};
 
 class Bus {
 
@@ -48,7 +98,10 @@ class Bus {
     // If send is nullptr, zeros will be sent.
     // If recv is nullptr, received data will be ignored.
     // If both arrays are present, both _must_ be of at least size count
-    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) {
+    // The default implementation falls back to the single byte transfer
+    // method. Buses that can move whole buffers at once (FIFOs, DMA, etc.)
+    // should override this, as it is the path used for all socket data.
+    virtual void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) {
         // If you're not sending or receiving anything, why are you here
         if (send == nullptr && recv == nullptr) {
             return;
@@ -83,15 +136,71 @@ class Bus {
     virtual void chip_select() = 0;
     virtual void chip_deselect() = 0;
 
+    // Scatter-gather transfer. All segments are clocked out back to back
+    // under a single chip select, so that e.g. a command header and its
+    // payload don't need to be copied into one contiguous buffer.
+    virtual void transfer(const Segment *segments, size_t count) {
+        chip_select();
+        for (size_t i = 0; i < count; i++) {
+            spi_xfer(segments[i].send, segments[i].recv, segments[i].count);
+        }
+        chip_deselect();
+    }
+
+    // Asynchronous transactions.
+    // Queue a transaction for execution. The default implementation simply
+    // runs the transaction synchronously, so buses without DMA support need
+    // not implement anything. Buses that do override this must ensure that
+    // any synchronous access (chip_select) waits for queued transactions to
+    // finish first.
+    virtual void submit(Transaction &txn) {
+        begin_transaction(txn);
+        transfer(txn.segments, txn.segment_count);
+        complete_transaction(txn);
+    }
+
+    // Make progress on any queued transactions. Interrupt driven buses may
+    // do nothing here, polled implementations should do their work here.
+    virtual void poll() {}
+
+    // True if no transactions are queued or in flight
+    virtual bool idle() { return true; }
+
+    // Block until a transaction has completed
+    void wait(Transaction &txn) {
+        while (txn.pending()) {
+            poll();
+        }
+    }
+
     // Interrupt handling.
     // Attach an interrupt using your target framework, and call
-    // this method from it.
-    void trigger_interrupt() { _interrupt_pending = true; }
-    bool has_pending_interrupt() { return _interrupt_pending; }
+    // this method from it. Buses that wrap another bus forward these to it.
+    virtual void trigger_interrupt() { _interrupt_pending = true; }
+    virtual bool has_pending_interrupt() { return _interrupt_pending; }
 
   protected:
-    void clear_interrupt_flag() { _interrupt_pending = false; }
+    virtual void clear_interrupt_flag() { _interrupt_pending = false; }
+    // Clear the flag of a wrapped bus
+    static void clear_interrupt_flag(Bus &bus) { bus.clear_interrupt_flag(); }
+
+    // Transaction state management, for bus implementations
+    static void begin_transaction(Transaction &txn) {
+        txn._state = Transaction::State::PENDING;
+        txn._next = nullptr;
+    }
+    static void complete_transaction(Transaction &txn) {
+        txn._state = Transaction::State::COMPLETE;
+        if (txn.callback != nullptr) {
+            txn.callback(txn, txn.callback_ctx);
+        }
+    }
+    static Transaction *&next_transaction(Transaction &txn) {
+        return txn._next;
+    }
+
     friend class W5500;
+    template <typename BusT> friend class Static::W5500;
 
   private:
     bool _interrupt_pending = false;
@@ -0,0 +1,275 @@
+#ifndef _W5500__W5500_BUSES_LINUXSPIDEV_H_
+#define _W5500__W5500_BUSES_LINUXSPIDEV_H_
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/spi/spidev.h>
+
+#include <W5500/Bus.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// Bus for Linux userspace, through the spidev interface.
+// Rather than issuing an ioctl per spi_xfer call, every chip select window
+// is staged as a list of spi_ioc_transfer entries and sent to the kernel as
+// a single SPI_IOC_MESSAGE when the window closes.
+//
+// Between begin_batch() and end_batch(), windows that only write are not
+// sent when they close; they are held back and sent together with the
+// following windows, with cs_change separating them, so that e.g. a run of
+// register writes costs one ioctl. Any window that reads (or that needs
+// data too large to stage) flushes the batch as it closes, so that read
+// results are always valid once the driver's access returns.
+//
+// Received data is written once the window closes, except for single byte
+// transfers, which are sent immediately with the chip select held asserted.
+// spidev limits the size of one message to its bufsiz module parameter
+// (4096 bytes by default), so it may need raising for large buffer reads.
+//
+// The ioctl itself goes through an Io object, so that the staging can be
+// exercised against something other than a real device.
+class LinuxSpidev : public Bus {
+  public:
+    // Kernel interface
+    class Io {
+      public:
+        virtual ~Io() = default;
+        // Run one SPI message. Returns a negative value on failure, as
+        // ioctl(SPI_IOC_MESSAGE) does.
+        virtual int message(const spi_ioc_transfer *transfers,
+                            size_t count) = 0;
+    };
+
+    // A /dev/spidevB.C device
+    class DeviceIo : public Io {
+      public:
+        DeviceIo(const char *path, uint32_t speed_hz,
+                 uint8_t mode = SPI_MODE_0) {
+            _fd = open(path, O_RDWR);
+            if (_fd < 0) {
+                return;
+            }
+            uint8_t bits = 8;
+            if (ioctl(_fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+                ioctl(_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+                ioctl(_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0) {
+                close(_fd);
+                _fd = -1;
+            }
+        }
+        ~DeviceIo() override {
+            if (_fd >= 0) {
+                close(_fd);
+            }
+        }
+
+        bool is_open() const { return _fd >= 0; }
+
+        int message(const spi_ioc_transfer *transfers,
+                    size_t count) override {
+            return ioctl(_fd, SPI_IOC_MESSAGE(count), transfers);
+        }
+
+      private:
+        int _fd;
+    };
+
+    // Runs messages against another Bus, such as Buses::Simulator, with the
+    // same chip select semantics as the kernel: cs_change deselects between
+    // transfers, and on the final transfer keeps the device selected.
+    class SimulatedIo : public Io {
+      public:
+        SimulatedIo(Bus &target) : _target(target) {}
+
+        int message(const spi_ioc_transfer *transfers,
+                    size_t count) override {
+            int total = 0;
+            for (size_t i = 0; i < count; i++) {
+                const spi_ioc_transfer &xfer = transfers[i];
+                if (!_selected) {
+                    _target.chip_select();
+                    _selected = true;
+                }
+                if (xfer.len > 0) {
+                    _target.spi_xfer(pointer(xfer.tx_buf),
+                                     pointer(xfer.rx_buf), xfer.len);
+                }
+                total += xfer.len;
+                const bool last = i + 1 == count;
+                if (bool(xfer.cs_change) != last) {
+                    _target.chip_deselect();
+                    _selected = false;
+                }
+            }
+            return total;
+        }
+
+      private:
+        Bus &_target;
+        bool _selected = false;
+
+        static uint8_t *pointer(uint64_t address) {
+            return reinterpret_cast<uint8_t *>(
+                static_cast<uintptr_t>(address));
+        }
+    };
+
+    struct Stats {
+        uint64_t ioctls = 0;
+        uint64_t transfers = 0;
+        uint64_t windows = 0;
+        uint64_t errors = 0;
+    };
+
+    LinuxSpidev(Io &io) : _io(io) {}
+    ~LinuxSpidev() override { flush(false); };
+
+    uint64_t millis() override {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return uint64_t(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+    }
+
+    void log(const char *msg, ...) override {
+        va_list args;
+        va_start(args, msg);
+        vfprintf(stderr, msg, args);
+        va_end(args);
+    }
+
+    void chip_select() override {
+        _in_window = true;
+        _window_needs_flush = false;
+        _stats.windows++;
+    }
+
+    void chip_deselect() override {
+        _in_window = false;
+
+        // If the chip select was left asserted by an earlier flush, the
+        // message that releases it needs at least one transfer
+        if (_cs_held && _count == 0) {
+            stage(nullptr, nullptr, 0);
+        }
+        if (_count == 0) {
+            return;
+        }
+
+        if (!_batching || _window_needs_flush) {
+            flush(false);
+        } else {
+            // Deselect before the next window in the batch
+            _transfers[_count - 1].cs_change = 1;
+        }
+    }
+
+    // Single byte transfers return their result immediately
+    void spi_xfer(uint8_t send, uint8_t *recv) override {
+        stage(&send, recv, 1);
+        flush(_in_window);
+    }
+
+    using Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        if (count == 0) {
+            return;
+        }
+        stage(send, recv, count);
+        if (!_in_window) {
+            flush(false);
+        }
+    }
+
+    // Hold back write-only windows until end_batch()
+    void begin_batch() { _batching = true; }
+    void end_batch() {
+        _batching = false;
+        if (!_in_window) {
+            flush(false);
+        }
+    }
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    Io &_io;
+    Stats _stats;
+
+    static const size_t max_transfers = 64;
+    static const size_t staging_size = 4096;
+
+    // Staged message, and copies of the data it sends
+    spi_ioc_transfer _transfers[max_transfers];
+    size_t _count = 0;
+    uint8_t _staging[staging_size];
+    size_t _staged_bytes = 0;
+
+    bool _in_window = false;
+    bool _window_needs_flush = false;
+    bool _batching = false;
+    // Chip select left asserted at the end of the last message
+    bool _cs_held = false;
+
+    void stage(const uint8_t *send, uint8_t *recv, size_t count) {
+        if (_count == max_transfers) {
+            flush(_in_window);
+        }
+
+        // Outgoing data is copied, since the caller's buffers (e.g. the
+        // command header) may be gone by the time the message is sent. Data
+        // too large to copy is referenced in place, which means the window
+        // has to be sent before the caller gets control back.
+        const uint8_t *tx = send;
+        if (send != nullptr) {
+            if (count <= staging_size - _staged_bytes) {
+                memcpy(&_staging[_staged_bytes], send, count);
+                tx = &_staging[_staged_bytes];
+                _staged_bytes += count;
+            } else {
+                _window_needs_flush = true;
+            }
+        }
+        if (recv != nullptr) {
+            _window_needs_flush = true;
+        }
+
+        spi_ioc_transfer &xfer = _transfers[_count++];
+        memset(&xfer, 0, sizeof(xfer));
+        xfer.tx_buf = reinterpret_cast<uintptr_t>(tx);
+        xfer.rx_buf = reinterpret_cast<uintptr_t>(recv);
+        xfer.len = count;
+    }
+
+    // Send everything staged as one message, optionally leaving the chip
+    // selected afterwards
+    void flush(bool hold_cs) {
+        if (_count == 0) {
+            return;
+        }
+        _transfers[_count - 1].cs_change = hold_cs ? 1 : 0;
+        if (_io.message(_transfers, _count) < 0) {
+            _stats.errors++;
+            log("SPI_IOC_MESSAGE failed for %u transfers\n",
+                static_cast<unsigned>(_count));
+        }
+        _stats.ioctls++;
+        _stats.transfers += _count;
+        _count = 0;
+        _staged_bytes = 0;
+        _cs_held = hold_cs;
+    }
+};
+
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_LINUXSPIDEV_H_
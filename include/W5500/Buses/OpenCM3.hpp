@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+#include <libopencm3/cm3/cortex.h>
 #include <libopencm3/stm32/gpio.h>
 #include <libopencm3/stm32/spi.h>
 
@@ -40,14 +41,115 @@ class OpenCM3 : public Bus {
         *recv = SPI_DR8(_spi);
     }
 
+    // Bulk transfer. Unhide the single byte helper from Bus as well.
+    using Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        // Nothing to send or receive
+        if (send == nullptr && recv == nullptr) {
+            return;
+        }
+
+        // If the received data is going to be discarded, don't wait on it
+        if (recv == nullptr) {
+            spi_send(send, count);
+            return;
+        }
+
+        // Pipelined transfer: queue the next byte while the previous one is
+        // still being shifted out, so that the bus doesn't idle between
+        // frames while we read out the last one. With two frames in flight
+        // (one in the shift register, one buffered), parts without an RX
+        // FIFO overrun unless the first is read before the second completes,
+        // so interrupts are masked from queuing a frame until the one ahead
+        // of it has been read. Between frames only one is in flight, and an
+        // interrupt can take as long as it likes.
+        size_t sent = 0;
+        size_t received = 0;
+        size_t frames_in_flight = max_frames_in_flight;
+        while (received < count) {
+            const uint32_t masked = cm_mask_interrupts(1);
+            while (sent < count && sent - received < frames_in_flight) {
+                while (!(SPI_SR(_spi) & SPI_SR_TXE))
+                    ;
+                SPI_DR8(_spi) = (send != nullptr ? send[sent] : 0x0);
+                sent++;
+            }
+            uint32_t status;
+            do {
+                status = SPI_SR(_spi);
+            } while (!(status & (SPI_SR_RXNE | SPI_SR_OVR)));
+            if (status & SPI_SR_OVR) {
+                // Still too slow to keep up, so finish in lock-step
+                received = recover_overrun(recv, sent, received);
+                frames_in_flight = 1;
+            } else {
+                recv[received++] = SPI_DR8(_spi);
+            }
+            cm_mask_interrupts(masked);
+        }
+    }
+
+    // Frames lost to RX overruns in pipelined transfers. The data returned
+    // for those transfers is incomplete.
+    uint32_t overruns() const { return _overruns; }
+
     // Chip select pin manipulation
     void chip_select() override { gpio_clear(_cs_port, _cs_pin); }
     virtual void chip_deselect() override { gpio_set(_cs_port, _cs_pin); }
 
-  private:
+  protected:
     const uint32_t _spi;
+
+    // Transmit-only transfer. Keeps the TX buffer full and throws away MISO
+    // data as it arrives, rather than waiting for each byte to be echoed.
+    void spi_send(const uint8_t *send, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            // Wait for TX available
+            while (!(SPI_SR(_spi) & SPI_SR_TXE))
+                ;
+            SPI_DR8(_spi) = send[i];
+
+            // Opportunistically drain the RX side
+            if (SPI_SR(_spi) & SPI_SR_RXNE) {
+                (void)SPI_DR8(_spi);
+            }
+        }
+
+        // Wait for the final frame to leave the shift register
+        while (SPI_SR(_spi) & SPI_SR_BSY)
+            ;
+
+        // Discard any remaining RX data. Reading DR followed by SR also
+        // clears the overrun flag, if we fell behind.
+        while (SPI_SR(_spi) & SPI_SR_RXNE) {
+            (void)SPI_DR8(_spi);
+        }
+        (void)SPI_SR(_spi);
+    }
+
+  private:
+    static const size_t max_frames_in_flight = 2;
+
+    // Resynchronise after an RX overrun in a pipelined transfer. DR still
+    // holds the oldest unread frame, and the frames behind it were lost.
+    // Their place in recv is left untouched, and the loss is counted and
+    // logged. Returns the new count of received frames.
+    size_t recover_overrun(uint8_t *recv, size_t sent, size_t received) {
+        // Let everything in flight finish
+        while (SPI_SR(_spi) & SPI_SR_BSY)
+            ;
+        // Reading DR followed by SR clears the overrun flag
+        recv[received++] = SPI_DR8(_spi);
+        (void)SPI_SR(_spi);
+        const size_t lost = sent - received;
+        _overruns += lost;
+        log("SPI RX overrun, %u frames lost\n", unsigned(lost));
+        return sent;
+    }
+
     const uint32_t _cs_port;
     const uint32_t _cs_pin;
+    uint32_t _overruns = 0;
 };
 } // namespace Buses
 } // namespace W5500
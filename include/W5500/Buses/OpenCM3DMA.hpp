@@ -0,0 +1,220 @@
+#ifndef _W5500__W5500_BUSES_OPENCM3DMA_H_
+#define _W5500__W5500_BUSES_OPENCM3DMA_H_
+
+#include <stdint.h>
+
+#include <libopencm3/cm3/cortex.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/stm32/spi.h>
+
+#include <W5500/Buses/OpenCM3.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// OpenCM3 bus with DMA-backed asynchronous transactions.
+// Transactions are queued and executed in submission order. Short segments
+// such as command headers are clocked out by the CPU, and larger ones are
+// handed to a pair of DMA channels (RX and TX) connected to the SPI
+// peripheral, moving on to the next segment from the completion interrupt.
+//
+// The RX channel transfer complete interrupt should be enabled in the NVIC,
+// and its handler should call dma_isr(). Alternatively, poll() may be called
+// periodically to check for completion without interrupts. Both may be used
+// together: poll() masks interrupts while it checks for completion.
+//
+// This uses the channel based DMA API (dma_channel_reset() etc.) of the
+// STM32 F0, F1, F3, L0 and L1 families. Parts with stream based DMA
+// controllers, such as the F2, F4 and F7, are not supported.
+class OpenCM3DMA : public OpenCM3 {
+  public:
+    OpenCM3DMA(uint32_t spi, uint32_t cs_port, uint32_t cs_pin, uint32_t dma,
+               uint8_t rx_channel, uint8_t tx_channel)
+        : OpenCM3(spi, cs_port, cs_pin), _dma(dma),
+          _rx_channel(rx_channel), _tx_channel(tx_channel) {}
+    ~OpenCM3DMA() override{};
+
+    // Synchronous accesses must wait for the DMA queue to drain
+    void chip_select() override {
+        wait_idle();
+        OpenCM3::chip_select();
+    }
+
+    void submit(Transaction &txn) override {
+        begin_transaction(txn);
+
+        // Append to the queue, starting it if the bus is idle
+        const uint32_t masked = cm_mask_interrupts(1);
+        const bool start = (_head == nullptr);
+        if (start) {
+            _head = &txn;
+        } else {
+            next_transaction(*_tail) = &txn;
+        }
+        _tail = &txn;
+        cm_mask_interrupts(masked);
+
+        if (start) {
+            start_transaction();
+        }
+    }
+
+    void poll() override {
+        // Don't race the interrupt handler for the completion flag
+        const uint32_t masked = cm_mask_interrupts(1);
+        const bool segment_done = take_completion();
+        cm_mask_interrupts(masked);
+        if (segment_done) {
+            continue_transaction();
+        }
+    }
+
+    bool idle() override { return _head == nullptr; }
+
+    // Call from the RX channel DMA interrupt handler
+    void dma_isr() {
+        if (take_completion()) {
+            continue_transaction();
+        }
+    }
+
+  private:
+    // Segments up to this size are sent by the CPU rather than DMA
+    static const size_t max_polled_segment_size = 8;
+
+    const uint32_t _dma;
+    const uint8_t _rx_channel;
+    const uint8_t _tx_channel;
+
+    // Queue of pending transactions. Head is the one in flight.
+    Transaction *volatile _head = nullptr;
+    Transaction *_tail = nullptr;
+
+    // Index of the next segment of the head transaction
+    size_t _segment = 0;
+
+    // Source / sink for the unused direction of a one-way transfer
+    uint8_t _dummy_tx = 0x0;
+    uint8_t _dummy_rx;
+
+    // DMA addresses are 32-bit
+    static uint32_t address_of(const volatile void *ptr) {
+        return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr));
+    }
+
+    void wait_idle() {
+        while (_head != nullptr) {
+            poll();
+        }
+    }
+
+    // If the DMA segment in flight has finished, acknowledge it and tear
+    // down the DMA. Only one caller may see each completion.
+    bool take_completion() {
+        if (_head == nullptr ||
+            !dma_get_interrupt_flag(_dma, _rx_channel, DMA_TCIF)) {
+            return false;
+        }
+        dma_clear_interrupt_flags(_dma, _rx_channel, DMA_TCIF);
+        stop_dma();
+        return true;
+    }
+
+    void start_transaction() {
+        OpenCM3::chip_select();
+        _segment = 0;
+        continue_transaction();
+    }
+
+    // Work through the remaining segments of the transaction at the head of
+    // the queue. Short segments (command headers) are clocked out by the CPU,
+    // as setting up DMA would take longer. Larger ones are handed to DMA, and
+    // the transaction resumes from the completion interrupt.
+    void continue_transaction() {
+        Transaction &txn = *_head;
+        while (_segment < txn.segment_count) {
+            const Segment &segment = txn.segments[_segment++];
+            if (segment.count <= max_polled_segment_size) {
+                spi_xfer(segment.send, segment.recv, segment.count);
+            } else {
+                start_dma(segment);
+                return;
+            }
+        }
+        finish_transaction();
+    }
+
+    void start_dma(const Segment &segment) {
+        // RX channel: peripheral -> memory
+        dma_channel_reset(_dma, _rx_channel);
+        dma_set_peripheral_address(_dma, _rx_channel,
+                                   address_of(&SPI_DR(_spi)));
+        dma_set_read_from_peripheral(_dma, _rx_channel);
+        dma_set_peripheral_size(_dma, _rx_channel, DMA_CCR_PSIZE_8BIT);
+        dma_set_memory_size(_dma, _rx_channel, DMA_CCR_MSIZE_8BIT);
+        dma_set_priority(_dma, _rx_channel, DMA_CCR_PL_VERY_HIGH);
+        if (segment.recv != nullptr) {
+            dma_set_memory_address(_dma, _rx_channel, address_of(segment.recv));
+            dma_enable_memory_increment_mode(_dma, _rx_channel);
+        } else {
+            dma_set_memory_address(_dma, _rx_channel, address_of(&_dummy_rx));
+            dma_disable_memory_increment_mode(_dma, _rx_channel);
+        }
+        dma_set_number_of_data(_dma, _rx_channel, segment.count);
+        dma_enable_transfer_complete_interrupt(_dma, _rx_channel);
+
+        // TX channel: memory -> peripheral
+        dma_channel_reset(_dma, _tx_channel);
+        dma_set_peripheral_address(_dma, _tx_channel,
+                                   address_of(&SPI_DR(_spi)));
+        dma_set_read_from_memory(_dma, _tx_channel);
+        dma_set_peripheral_size(_dma, _tx_channel, DMA_CCR_PSIZE_8BIT);
+        dma_set_memory_size(_dma, _tx_channel, DMA_CCR_MSIZE_8BIT);
+        if (segment.send != nullptr) {
+            dma_set_memory_address(_dma, _tx_channel, address_of(segment.send));
+            dma_enable_memory_increment_mode(_dma, _tx_channel);
+        } else {
+            dma_set_memory_address(_dma, _tx_channel, address_of(&_dummy_tx));
+            dma_disable_memory_increment_mode(_dma, _tx_channel);
+        }
+        dma_set_number_of_data(_dma, _tx_channel, segment.count);
+
+        // RX must be armed before TX starts clocking
+        dma_enable_channel(_dma, _rx_channel);
+        dma_enable_channel(_dma, _tx_channel);
+        spi_enable_rx_dma(_spi);
+        spi_enable_tx_dma(_spi);
+    }
+
+    void stop_dma() {
+        // Tear down the DMA request lines. Since completion is signalled by
+        // the RX channel, all frames have already left the shift register.
+        spi_disable_rx_dma(_spi);
+        spi_disable_tx_dma(_spi);
+        dma_disable_channel(_dma, _rx_channel);
+        dma_disable_channel(_dma, _tx_channel);
+    }
+
+    void finish_transaction() {
+        Transaction &txn = *_head;
+        OpenCM3::chip_deselect();
+
+        // Pop the queue
+        const uint32_t masked = cm_mask_interrupts(1);
+        _head = next_transaction(txn);
+        if (_head == nullptr) {
+            _tail = nullptr;
+        }
+        cm_mask_interrupts(masked);
+
+        // Notify the owner, then kick off the next transaction
+        complete_transaction(txn);
+        if (_head != nullptr) {
+            start_transaction();
+        }
+    }
+};
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_OPENCM3DMA_H_
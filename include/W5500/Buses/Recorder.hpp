@@ -0,0 +1,219 @@
+#ifndef _W5500__W5500_BUSES_RECORDER_H_
+#define _W5500__W5500_BUSES_RECORDER_H_
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <W5500/Bus.hpp>
+#include <W5500/Buses/Recording.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// Bus decorator that logs a session to a Recording::Sink.
+// Every access is forwarded to the target bus unchanged, and logged along
+// with the data that came back, so that the session can later be replayed
+// on a host with Buses::Replay. See Recording.hpp for the log format.
+//
+// Log data is staged in a small internal buffer and handed to the sink in
+// chunks; call flush() before reading back a log that is still being
+// written. Asynchronous transactions are run synchronously through the
+// target, so that they appear in the log in the order they were submitted.
+// Interrupts are forwarded to the target, and each one the driver picks up
+// is logged.
+//
+// Recording must not change the session, so the recorder never reads the
+// target's clock on its own account (the simulator's clock, for one, can
+// move on every read). Chip selects are stamped with the time the driver
+// last read, unless a clock without side effects is given with set_clock().
+class Recorder : public Bus {
+  public:
+    // Current time in milliseconds, for stamping chip selects
+    typedef uint64_t (*Clock)(void *ctx);
+
+    // If record_mosi is false, only the data returned by the IC is logged.
+    // This roughly halves the size of the log, but the replay side can no
+    // longer check that the driver sent the same data.
+    Recorder(Bus &target, Recording::Sink &sink, bool record_mosi = true)
+        : _target(target), _sink(sink), _record_mosi(record_mosi) {
+        put(Recording::magic, sizeof(Recording::magic));
+        put(&Recording::version, 1);
+    }
+    ~Recorder() override { flush(); };
+
+    void init() override { _target.init(); }
+    void log(const char *msg, ...) override {
+        char line[128];
+        va_list args;
+        va_start(args, msg);
+        vsnprintf(line, sizeof(line), msg, args);
+        va_end(args);
+        _target.log("%s", line);
+    }
+
+    uint64_t millis() override {
+        const uint64_t now = _target.millis();
+        put_record(Recording::Record::MILLIS);
+        put_varint(timestamp_delta(now));
+        return now;
+    }
+
+    void set_clock(Clock clock, void *ctx) {
+        _clock = clock;
+        _clock_ctx = ctx;
+    }
+
+    uint64_t random() override {
+        const uint64_t value = _target.random();
+        put_record(Recording::Record::RANDOM);
+        put_varint(value);
+        return value;
+    }
+
+    void spi_xfer(uint8_t send, uint8_t *recv) override {
+        _target.spi_xfer(send, recv);
+        record_xfer(&send, recv, 1);
+    }
+
+    using Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        _target.spi_xfer(send, recv, count);
+        while (count > 0) {
+            const size_t chunk = count < Recording::max_xfer_record
+                                     ? count
+                                     : Recording::max_xfer_record;
+            record_xfer(send, recv, chunk);
+            send = send != nullptr ? send + chunk : nullptr;
+            recv = recv != nullptr ? recv + chunk : nullptr;
+            count -= chunk;
+        }
+    }
+
+    void chip_select() override {
+        put_record(Recording::Record::SELECT);
+        put_varint(_clock != nullptr ? timestamp_delta(_clock(_clock_ctx)) : 0);
+        _target.chip_select();
+    }
+
+    void trigger_interrupt() override { _target.trigger_interrupt(); }
+    bool has_pending_interrupt() override {
+        if (!_target.has_pending_interrupt()) {
+            _idle_interrupt_checks++;
+            return false;
+        }
+        const uint64_t idle_checks = _idle_interrupt_checks;
+        put_record(Recording::Record::INTERRUPT);
+        put_varint(idle_checks);
+        return true;
+    }
+    void clear_interrupt_flag() override {
+        Bus::clear_interrupt_flag(_target);
+    }
+
+    void chip_deselect() override {
+        _target.chip_deselect();
+        put_record(Recording::Record::DESELECT);
+    }
+
+    // Hand any buffered log data to the sink
+    void flush() {
+        flush_buffer();
+        _sink.flush();
+    }
+
+    // Total bytes of log produced so far
+    uint64_t log_size() const { return _log_size; }
+
+  private:
+    Bus &_target;
+    Recording::Sink &_sink;
+    const bool _record_mosi;
+    Clock _clock = nullptr;
+    void *_clock_ctx = nullptr;
+    // Interrupt checks that came up empty since the last record
+    uint64_t _idle_interrupt_checks = 0;
+
+    uint64_t _last_ms = 0;
+    uint64_t _log_size = 0;
+
+    static const size_t buffer_size = 64;
+    uint8_t _buffer[buffer_size];
+    size_t _used = 0;
+
+    uint64_t timestamp_delta(uint64_t now) {
+        // Clocks that go backwards are logged as standing still
+        const uint64_t delta = now > _last_ms ? now - _last_ms : 0;
+        _last_ms += delta;
+        return delta;
+    }
+
+    void record_xfer(const uint8_t *send, const uint8_t *recv, size_t count) {
+        // A null send buffer is all zeros, and a null recv buffer means the
+        // driver didn't care about the result, so neither needs logging
+        uint8_t flags = 0;
+        if (send != nullptr && _record_mosi) {
+            flags |= Recording::FLAG_MOSI;
+        }
+        if (recv != nullptr) {
+            flags |= Recording::FLAG_MISO;
+        }
+
+        put_record(Recording::Record::XFER);
+        put_varint(count);
+        put(&flags, 1);
+        if (flags & Recording::FLAG_MOSI) {
+            put(send, count);
+        }
+        if (flags & Recording::FLAG_MISO) {
+            put(recv, count);
+        }
+    }
+
+    void put_record(Recording::Record record) {
+        _idle_interrupt_checks = 0;
+        const uint8_t tag = static_cast<uint8_t>(record);
+        put(&tag, 1);
+    }
+
+    void put_varint(uint64_t value) {
+        uint8_t bytes[10];
+        size_t size = 0;
+        do {
+            bytes[size] = value & 0x7F;
+            value >>= 7;
+            if (value) {
+                bytes[size] |= 0x80;
+            }
+            size++;
+        } while (value);
+        put(bytes, size);
+    }
+
+    void put(const uint8_t *data, size_t size) {
+        _log_size += size;
+        if (size > buffer_size - _used) {
+            flush_buffer();
+        }
+        if (size >= buffer_size) {
+            // Large payloads go straight through
+            _sink.write(data, size);
+            return;
+        }
+        memcpy(&_buffer[_used], data, size);
+        _used += size;
+    }
+
+    void flush_buffer() {
+        if (_used > 0) {
+            _sink.write(_buffer, _used);
+            _used = 0;
+        }
+    }
+};
+
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_RECORDER_H_
@@ -0,0 +1,147 @@
+#ifndef _W5500__W5500_BUSES_RECORDING_H_
+#define _W5500__W5500_BUSES_RECORDING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace W5500 {
+namespace Buses {
+namespace Recording {
+
+// Bus session log format, as written by Buses::Recorder and read back by
+// Buses::Replay.
+//
+// The log is a stream of records, preceded by a 5 byte header: the magic
+// "W5SR" and a format version. Each record is a one byte tag followed by
+// its fields. Integers are unsigned LEB128 varints, so the common case of a
+// small delta or length costs a single byte.
+//
+//   SELECT    varint ms since the previous timestamp
+//   XFER      varint count, flags byte, then count MOSI bytes if
+//             FLAG_MOSI is set and count MISO bytes if FLAG_MISO is set
+//   DESELECT  (no fields)
+//   MILLIS    varint ms since the previous timestamp
+//   RANDOM    varint value
+//   INTERRUPT varint checks that found no interrupt pending since the
+//             previous record, before this one found one
+//
+// Transfers longer than max_xfer_record bytes are split over several XFER
+// records, so that a reader never needs to hold more than that much data.
+//
+// Records are only ever appended, so a log can be streamed to a file or a
+// serial port as it is captured, and replayed from a stream without having
+// to fit in memory.
+static const uint8_t magic[4] = {'W', '5', 'S', 'R'};
+static const uint8_t version = 2;
+// Oldest version Replay can read. Version 1 had no INTERRUPT records.
+static const uint8_t min_version = 1;
+
+enum class Record : uint8_t {
+    SELECT = 0x01,
+    XFER = 0x02,
+    DESELECT = 0x03,
+    MILLIS = 0x04,
+    RANDOM = 0x05,
+    INTERRUPT = 0x06,
+};
+
+static const size_t max_xfer_record = 256;
+
+// XFER flags
+static const uint8_t FLAG_MOSI = 0b01;
+static const uint8_t FLAG_MISO = 0b10;
+
+// Destination for a log
+class Sink {
+  public:
+    virtual ~Sink() = default;
+    virtual void write(const uint8_t *data, size_t size) = 0;
+    virtual void flush() {}
+};
+
+// Origin of a log. Returns the number of bytes read, which is only less
+// than size at the end of the log.
+class Source {
+  public:
+    virtual ~Source() = default;
+    virtual size_t read(uint8_t *data, size_t size) = 0;
+};
+
+// stdio backed sink and source, for host side capture and replay or for
+// targets with a filesystem
+class FileSink : public Sink {
+  public:
+    FileSink(FILE *file) : _file(file) {}
+
+    void write(const uint8_t *data, size_t size) override {
+        fwrite(data, 1, size, _file);
+    }
+    void flush() override { fflush(_file); }
+
+  private:
+    FILE *_file;
+};
+
+class FileSource : public Source {
+  public:
+    FileSource(FILE *file) : _file(file) {}
+
+    size_t read(uint8_t *data, size_t size) override {
+        return fread(data, 1, size, _file);
+    }
+
+  private:
+    FILE *_file;
+};
+
+// In-memory sink and source, for short captures
+class BufferSink : public Sink {
+  public:
+    BufferSink(uint8_t *buffer, size_t size) : _buffer(buffer), _size(size) {}
+
+    void write(const uint8_t *data, size_t size) override {
+        if (size > _size - _used) {
+            _overflowed = true;
+            size = _size - _used;
+        }
+        memcpy(&_buffer[_used], data, size);
+        _used += size;
+    }
+
+    size_t used() const { return _used; }
+    bool overflowed() const { return _overflowed; }
+
+  private:
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _used = 0;
+    bool _overflowed = false;
+};
+
+class BufferSource : public Source {
+  public:
+    BufferSource(const uint8_t *buffer, size_t size)
+        : _buffer(buffer), _size(size) {}
+
+    size_t read(uint8_t *data, size_t size) override {
+        if (size > _size - _offset) {
+            size = _size - _offset;
+        }
+        memcpy(data, &_buffer[_offset], size);
+        _offset += size;
+        return size;
+    }
+
+  private:
+    const uint8_t *_buffer;
+    size_t _size;
+    size_t _offset = 0;
+};
+
+} // namespace Recording
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_RECORDING_H_
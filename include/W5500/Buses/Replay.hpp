@@ -0,0 +1,338 @@
+#ifndef _W5500__W5500_BUSES_REPLAY_H_
+#define _W5500__W5500_BUSES_REPLAY_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <W5500/Bus.hpp>
+#include <W5500/Buses/Recording.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// Bus that plays back a session captured with Buses::Recorder.
+// Data the IC returned is fed back to the driver, and time and random
+// numbers are taken from the log, so that a recorded session can be re-run
+// deterministically on a host for benchmarking and profiling.
+//
+// Within a chip select window the recorded data is treated as a byte
+// stream, so a driver that splits its transfers differently from the one
+// that made the recording still receives the same bytes. If the driver
+// under test diverges further than that (e.g. by skipping a register read),
+// playback resynchronises at the next chip select and the divergence is
+// counted in stats().
+//
+// Once the log is exhausted, reads return zeros and millis() advances by one
+// on every call so that driver timeouts still expire. Use finished() to stop
+// driving the replay.
+class Replay : public Bus {
+  public:
+    struct Stats {
+        // Chip select windows and data bytes replayed
+        uint64_t windows = 0;
+        uint64_t bytes = 0;
+        // Bytes the driver sent that differ from the recording
+        uint64_t mosi_mismatches = 0;
+        // Bytes the driver transferred beyond the end of a recorded window
+        uint64_t overrun_bytes = 0;
+        // Recorded bytes the driver never transferred
+        uint64_t skipped_bytes = 0;
+    };
+
+    Replay(Recording::Source &source) : _source(source) {
+        uint8_t header[sizeof(Recording::magic) + 1];
+        _valid = read_bytes(header, sizeof(header)) &&
+                 memcmp(header, Recording::magic, sizeof(Recording::magic)) ==
+                     0 &&
+                 header[sizeof(Recording::magic)] >= Recording::min_version &&
+                 header[sizeof(Recording::magic)] <= Recording::version;
+        if (!_valid) {
+            _eof = true;
+        }
+    }
+    ~Replay() override{};
+
+    void init() override {}
+
+    uint64_t millis() override {
+        if (peek() == Recording::Record::MILLIS) {
+            consume_timestamp();
+        } else if (finished()) {
+            _now_ms++;
+        }
+        return _now_ms;
+    }
+
+    // Interrupts are delivered to the same check that picked them up when
+    // the session was recorded
+    bool has_pending_interrupt() override {
+        if (!_interrupt_due) {
+            if (peek() != Recording::Record::INTERRUPT) {
+                return false;
+            }
+            consume();
+            _idle_interrupt_checks = read_varint();
+            _interrupt_due = true;
+        }
+        if (_idle_interrupt_checks > 0) {
+            _idle_interrupt_checks--;
+            return false;
+        }
+        _interrupt_due = false;
+        return true;
+    }
+
+    uint64_t random() override {
+        if (peek() != Recording::Record::RANDOM) {
+            return Bus::random();
+        }
+        consume();
+        return read_varint();
+    }
+
+    void spi_xfer(uint8_t send, uint8_t *recv) override {
+        spi_xfer(&send, recv, 1);
+    }
+
+    using Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        while (count > 0) {
+            if (_chunk_offset == _chunk_size && !load_chunk()) {
+                // Driver is reading past the end of the recorded window
+                if (recv != nullptr) {
+                    memset(recv, 0, count);
+                }
+                _stats.overrun_bytes += count;
+                return;
+            }
+
+            size_t n = _chunk_size - _chunk_offset;
+            if (n > count) {
+                n = count;
+            }
+            if (recv != nullptr) {
+                if (_chunk_flags & Recording::FLAG_MISO) {
+                    memcpy(recv, &_miso[_chunk_offset], n);
+                } else {
+                    memset(recv, 0, n);
+                }
+                recv += n;
+            }
+            if (_chunk_flags & Recording::FLAG_MOSI) {
+                for (size_t i = 0; i < n; i++) {
+                    const uint8_t sent = send != nullptr ? send[i] : 0;
+                    if (sent != _mosi[_chunk_offset + i]) {
+                        _stats.mosi_mismatches++;
+                    }
+                }
+            }
+            if (send != nullptr) {
+                send += n;
+            }
+
+            _chunk_offset += n;
+            _stats.bytes += n;
+            count -= n;
+        }
+    }
+
+    void chip_select() override {
+        // Skip anything the driver didn't consume to get to the next window
+        while (!finished() && peek() != Recording::Record::SELECT) {
+            skip_record();
+        }
+        if (finished()) {
+            return;
+        }
+        consume_timestamp();
+        _in_window = true;
+        _stats.windows++;
+    }
+
+    void chip_deselect() override {
+        _stats.skipped_bytes += _chunk_size - _chunk_offset;
+        _chunk_size = _chunk_offset = 0;
+        while (!finished() && peek() != Recording::Record::DESELECT &&
+               peek() != Recording::Record::SELECT) {
+            skip_record();
+        }
+        if (peek() == Recording::Record::DESELECT) {
+            consume();
+        }
+        _in_window = false;
+    }
+
+    // True if the log header was recognised
+    bool valid() const { return _valid; }
+
+    // True once the whole log has been played back
+    bool finished() { return peek_tag() < 0; }
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    Recording::Source &_source;
+    bool _valid;
+    Stats _stats;
+
+    uint64_t _now_ms = 0;
+    bool _in_window = false;
+
+    // An INTERRUPT record has been read, and is due after this many more
+    // checks
+    bool _interrupt_due = false;
+    uint64_t _idle_interrupt_checks = 0;
+
+    // Read buffer
+    static const size_t buffer_size = 256;
+    uint8_t _buffer[buffer_size];
+    size_t _buffer_used = 0;
+    size_t _buffer_offset = 0;
+    bool _eof = false;
+
+    // Next record tag, or -1 if it has not been read yet
+    int _tag = -1;
+
+    // Current XFER record
+    uint8_t _mosi[Recording::max_xfer_record];
+    uint8_t _miso[Recording::max_xfer_record];
+    uint8_t _chunk_flags = 0;
+    size_t _chunk_size = 0;
+    size_t _chunk_offset = 0;
+
+    // Load the next XFER record of the current window. Timestamps and random
+    // numbers recorded within the window are applied as they go by.
+    bool load_chunk() {
+        if (!_in_window) {
+            return false;
+        }
+        for (;;) {
+            const int tag = peek_tag();
+            if (tag == static_cast<int>(Recording::Record::MILLIS)) {
+                consume_timestamp();
+            } else if (tag == static_cast<int>(Recording::Record::RANDOM)) {
+                consume();
+                read_varint();
+            } else if (tag ==
+                       static_cast<int>(Recording::Record::INTERRUPT)) {
+                consume();
+                read_varint();
+            } else if (tag == static_cast<int>(Recording::Record::XFER)) {
+                break;
+            } else {
+                return false;
+            }
+        }
+        consume();
+        read_xfer();
+        return _chunk_size > 0;
+    }
+
+    void read_xfer() {
+        _chunk_size = read_varint();
+        _chunk_offset = 0;
+        _chunk_flags = 0;
+        if (_chunk_size > Recording::max_xfer_record ||
+            !read_bytes(&_chunk_flags, 1) ||
+            ((_chunk_flags & Recording::FLAG_MOSI) &&
+             !read_bytes(_mosi, _chunk_size)) ||
+            ((_chunk_flags & Recording::FLAG_MISO) &&
+             !read_bytes(_miso, _chunk_size))) {
+            // Truncated or corrupt log
+            _chunk_size = 0;
+            _eof = true;
+        }
+    }
+
+    void skip_record() {
+        const int tag = peek_tag();
+        consume();
+        switch (static_cast<Recording::Record>(tag)) {
+        case Recording::Record::SELECT:
+        case Recording::Record::MILLIS:
+            consume_timestamp_value();
+            break;
+        case Recording::Record::XFER:
+            read_xfer();
+            _stats.skipped_bytes += _chunk_size;
+            _chunk_size = 0;
+            break;
+        case Recording::Record::RANDOM:
+        case Recording::Record::INTERRUPT:
+            read_varint();
+            break;
+        case Recording::Record::DESELECT:
+            break;
+        default:
+            // Unknown record, nothing more can be decoded
+            _eof = true;
+            break;
+        }
+    }
+
+    void consume_timestamp() {
+        consume();
+        consume_timestamp_value();
+    }
+
+    void consume_timestamp_value() { _now_ms += read_varint(); }
+
+    Recording::Record peek() {
+        return static_cast<Recording::Record>(peek_tag());
+    }
+
+    int peek_tag() {
+        if (_tag < 0 && !_eof) {
+            uint8_t tag;
+            if (read_bytes(&tag, 1)) {
+                _tag = tag;
+            }
+        }
+        return _eof ? -1 : _tag;
+    }
+
+    void consume() { _tag = -1; }
+
+    uint64_t read_varint() {
+        uint64_t value = 0;
+        for (uint8_t shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!read_bytes(&byte, 1)) {
+                return value;
+            }
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    bool read_bytes(uint8_t *data, size_t size) {
+        while (size > 0) {
+            if (_buffer_offset == _buffer_used) {
+                _buffer_used = _source.read(_buffer, buffer_size);
+                _buffer_offset = 0;
+                if (_buffer_used == 0) {
+                    _eof = true;
+                    return false;
+                }
+            }
+            size_t n = _buffer_used - _buffer_offset;
+            if (n > size) {
+                n = size;
+            }
+            memcpy(data, &_buffer[_buffer_offset], n);
+            _buffer_offset += n;
+            data += n;
+            size -= n;
+        }
+        return true;
+    }
+};
+
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_REPLAY_H_
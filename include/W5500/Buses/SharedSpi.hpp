@@ -0,0 +1,231 @@
+#ifndef _W5500__W5500_BUSES_SHAREDSPI_H_
+#define _W5500__W5500_BUSES_SHAREDSPI_H_
+
+#include <stdint.h>
+
+#include <W5500/Bus.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// Arbiter for several W5500s sharing one SPI peripheral.
+// Each chip is given a SharedSpi::Device, which is the Bus its driver talks
+// to. A device wraps a port: a bus for the shared peripheral that drives
+// that chip's own chip select pin (e.g. one OpenCM3 bus per chip, all on the
+// same SPI but with different CS pins).
+//
+// Asynchronous transactions are queued per device and put on the wire one
+// at a time, taking one transaction from each device with work queued in
+// turn, so that a chip with a long queue of buffer transfers can't starve
+// the others. A synchronous access from a driver waits for its own queue
+// and whatever is currently on the wire, and holds off the other devices
+// until it deselects.
+class SharedSpi {
+  public:
+    class Device : public Bus {
+      public:
+        struct Stats {
+            uint32_t transactions = 0;
+            uint32_t windows = 0;
+            // Synchronous accesses that had to wait for the wire
+            uint32_t waits = 0;
+        };
+
+        Device(SharedSpi &shared, Bus &port) : _shared(shared), _port(port) {
+            _shared.attach(*this);
+        }
+        ~Device() override{};
+
+        void init() override {
+            _port.init();
+            Bus::init();
+        }
+        uint64_t millis() override { return _port.millis(); }
+        uint64_t random() override { return _port.random(); }
+
+        void spi_xfer(uint8_t send, uint8_t *recv) override {
+            _port.spi_xfer(send, recv);
+        }
+
+        using Bus::spi_xfer;
+        void spi_xfer(const uint8_t *send, uint8_t *recv,
+                      size_t count) override {
+            _port.spi_xfer(send, recv, count);
+        }
+
+        void chip_select() override {
+            _shared.acquire(*this);
+            _stats.windows++;
+            _port.chip_select();
+        }
+        void chip_deselect() override {
+            _port.chip_deselect();
+            _shared.release();
+        }
+
+        // Each chip has its own interrupt line, seen through its port
+        void trigger_interrupt() override { _port.trigger_interrupt(); }
+        bool has_pending_interrupt() override {
+            return _port.has_pending_interrupt();
+        }
+        void clear_interrupt_flag() override {
+            Bus::clear_interrupt_flag(_port);
+        }
+
+        void submit(Transaction &txn) override {
+            begin_transaction(txn);
+            if (_head == nullptr) {
+                _head = &txn;
+            } else {
+                next_transaction(*_tail) = &txn;
+            }
+            _tail = &txn;
+            _stats.transactions++;
+            _shared.service();
+        }
+
+        void poll() override { _shared.poll(); }
+
+        bool idle() override {
+            return _head == nullptr &&
+                   !(_shared._active_device == this && _shared.wire_busy());
+        }
+
+        const Stats &stats() const { return _stats; }
+        void reset_stats() { _stats = Stats(); }
+
+      private:
+        SharedSpi &_shared;
+        Bus &_port;
+        Stats _stats;
+
+        // Queued transactions
+        Transaction *_head = nullptr;
+        Transaction *_tail = nullptr;
+
+        // Next device on the same arbiter
+        Device *_next_device = nullptr;
+
+        Transaction &pop() {
+            Transaction &txn = *_head;
+            _head = next_transaction(txn);
+            if (_head == nullptr) {
+                _tail = nullptr;
+            }
+            return txn;
+        }
+
+        friend class SharedSpi;
+    };
+
+    SharedSpi() {}
+
+    // Make progress on whatever is on the wire, and start the next queued
+    // transaction once it is done
+    void poll() {
+        if (_active_device != nullptr) {
+            _active_device->_port.poll();
+        }
+        service();
+    }
+
+    // True if no device has transactions queued or in flight
+    bool idle() {
+        for (Device *device = _devices; device != nullptr;
+             device = device->_next_device) {
+            if (!device->idle()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    // All devices, and the one served most recently
+    Device *_devices = nullptr;
+    Device *_last_served = nullptr;
+
+    // Transaction on the wire, and the device it belongs to
+    Transaction *_active = nullptr;
+    Device *_active_device = nullptr;
+
+    // Device making a synchronous access, if any
+    Device *_claim = nullptr;
+    bool _servicing = false;
+
+    // Disallow copying
+    SharedSpi(const SharedSpi &);
+    SharedSpi &operator=(const SharedSpi &);
+
+    bool wire_busy() const { return _active != nullptr && _active->pending(); }
+
+    void attach(Device &device) {
+        device._next_device = _devices;
+        _devices = &device;
+    }
+
+    // Wait for the wire, and keep it until release()
+    void acquire(Device &device) {
+        _claim = &device;
+        if (device._head != nullptr || wire_busy()) {
+            device._stats.waits++;
+        }
+        while (device._head != nullptr || wire_busy()) {
+            poll();
+        }
+    }
+
+    void release() {
+        _claim = nullptr;
+        service();
+    }
+
+    // Round robin over the devices with queued transactions, starting after
+    // the last one served. While a device has claimed the wire, only its own
+    // queue is served.
+    Device *next_ready() {
+        if (_claim != nullptr) {
+            return _claim->_head != nullptr ? _claim : nullptr;
+        }
+        Device *device = _last_served;
+        for (Device *n = _devices; n != nullptr; n = n->_next_device) {
+            device = device == nullptr || device->_next_device == nullptr
+                         ? _devices
+                         : device->_next_device;
+            if (device->_head != nullptr) {
+                return device;
+            }
+        }
+        return nullptr;
+    }
+
+    void service() {
+        // Completion callbacks may submit more work; the outer call picks
+        // it up
+        if (_servicing || _devices == nullptr) {
+            return;
+        }
+        _servicing = true;
+        for (;;) {
+            if (wire_busy()) {
+                break;
+            }
+            _active = nullptr;
+            _active_device = nullptr;
+            Device *device = next_ready();
+            if (device == nullptr) {
+                break;
+            }
+            _last_served = device;
+            _active = &device->pop();
+            _active_device = device;
+            device->_port.submit(*_active);
+        }
+        _servicing = false;
+    }
+};
+
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_SHAREDSPI_H_
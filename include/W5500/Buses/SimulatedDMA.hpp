@@ -0,0 +1,164 @@
+#ifndef _W5500__W5500_BUSES_SIMULATEDDMA_H_
+#define _W5500__W5500_BUSES_SIMULATEDDMA_H_
+
+#include <stdint.h>
+
+#include <W5500/Bus.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// Host-side model of a DMA capable bus, for testing and benchmarking the
+// asynchronous transaction API on a development machine.
+// All data is forwarded to a target bus, which does the actual work of
+// talking to (or simulating) the IC. This class only models *when* that
+// happens: it keeps a simulated nanosecond clock, charges every byte on the
+// wire at the configured SPI bit rate, and completes queued transactions in
+// submission order once the clock passes their finish time.
+//
+// The CPU side of the simulation advances the clock explicitly with
+// advance(), to model time spent on other work. Synchronous accesses made
+// while transactions are still queued stall until the queue drains, and the
+// stall time is recorded, so that the overlap gained by going asynchronous
+// can be read back out of stats().
+class SimulatedDMA : public Bus {
+  public:
+    struct Stats {
+        uint64_t transactions = 0;
+        uint64_t async_bytes = 0;
+        uint64_t sync_bytes = 0;
+        // Total time the wire was busy
+        uint64_t bus_busy_ns = 0;
+        // Time the CPU spent waiting for queued transactions
+        uint64_t cpu_stall_ns = 0;
+    };
+
+    SimulatedDMA(Bus &target, uint32_t spi_hz)
+        : _target(target), _ns_per_byte(8000000000ULL / spi_hz) {}
+    ~SimulatedDMA() override{};
+
+    uint64_t millis() override { return _target.millis(); }
+    uint64_t random() override { return _target.random(); }
+
+    void spi_xfer(uint8_t send, uint8_t *recv) override {
+        _target.spi_xfer(send, recv);
+        charge_sync(1);
+    }
+
+    using Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        _target.spi_xfer(send, recv, count);
+        charge_sync(count);
+    }
+
+    void chip_select() override {
+        wait_idle();
+        _target.chip_select();
+    }
+    void chip_deselect() override { _target.chip_deselect(); }
+
+    // The interrupt line belongs to the target
+    void trigger_interrupt() override { _target.trigger_interrupt(); }
+    bool has_pending_interrupt() override {
+        return _target.has_pending_interrupt();
+    }
+    void clear_interrupt_flag() override {
+        Bus::clear_interrupt_flag(_target);
+    }
+
+    void submit(Transaction &txn) override {
+        begin_transaction(txn);
+        if (_head == nullptr) {
+            _head = &txn;
+            _head_done_ns = _now_ns + duration(txn);
+        } else {
+            next_transaction(*_tail) = &txn;
+        }
+        _tail = &txn;
+    }
+
+    void poll() override {
+        while (_head != nullptr && _head_done_ns <= _now_ns) {
+            finish_head();
+        }
+    }
+
+    bool idle() override { return _head == nullptr; }
+
+    // Simulated CPU time passes
+    void advance(uint64_t ns) {
+        _now_ns += ns;
+        poll();
+    }
+
+    uint64_t now_ns() const { return _now_ns; }
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    Bus &_target;
+    const uint64_t _ns_per_byte;
+
+    uint64_t _now_ns = 0;
+    Stats _stats;
+
+    // Queue of pending transactions, and the time the head will complete
+    Transaction *_head = nullptr;
+    Transaction *_tail = nullptr;
+    uint64_t _head_done_ns = 0;
+
+    static size_t size_of(const Transaction &txn) {
+        size_t size = 0;
+        for (size_t i = 0; i < txn.segment_count; i++) {
+            size += txn.segments[i].count;
+        }
+        return size;
+    }
+
+    uint64_t duration(const Transaction &txn) const {
+        return size_of(txn) * _ns_per_byte;
+    }
+
+    void charge_sync(size_t count) {
+        const uint64_t ns = count * _ns_per_byte;
+        _now_ns += ns;
+        _stats.sync_bytes += count;
+        _stats.bus_busy_ns += ns;
+    }
+
+    void wait_idle() {
+        while (_head != nullptr) {
+            if (_head_done_ns > _now_ns) {
+                _stats.cpu_stall_ns += _head_done_ns - _now_ns;
+                _now_ns = _head_done_ns;
+            }
+            finish_head();
+        }
+    }
+
+    void finish_head() {
+        Transaction &txn = *_head;
+
+        // Move the data now that the transfer has 'happened'
+        _target.transfer(txn.segments, txn.segment_count);
+
+        _stats.transactions++;
+        _stats.async_bytes += size_of(txn);
+        _stats.bus_busy_ns += duration(txn);
+
+        // Pop the queue. The next transaction starts on the wire as soon as
+        // this one finished.
+        _head = next_transaction(txn);
+        if (_head == nullptr) {
+            _tail = nullptr;
+        } else {
+            _head_done_ns += duration(*_head);
+        }
+
+        complete_transaction(txn);
+    }
+};
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_SIMULATEDDMA_H_
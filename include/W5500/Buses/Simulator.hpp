@@ -0,0 +1,885 @@
+#ifndef _W5500__W5500_BUSES_SIMULATOR_H_
+#define _W5500__W5500_BUSES_SIMULATOR_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <W5500/Bus.hpp>
+#include <W5500/Registers.hpp>
+
+namespace W5500 {
+namespace Buses {
+
+// Host-side model of a W5500, as seen from the SPI bus.
+// The simulator decodes SPI frames exactly as the IC does (two address
+// bytes, a control byte, then a variable length data phase), and backs them
+// with a model of the common and socket register files and the 16KB TX and
+// RX buffer memories, including the per-socket buffer allocation and the
+// wrap of buffer addresses within each socket's allocation.
+//
+// Socket commands drive a simplified state machine: OPEN, LISTEN, CONNECT,
+// DISCONNECT, CLOSE, SEND and RECV all update Sn_SR, the buffer pointers and
+// Sn_IR as the IC would, but no packets are actually exchanged. Instead, data
+// sent by the driver is handed to a transmit handler, and the network side
+// of the simulation injects received data, frames and connection events
+// with the inject_*() methods.
+//
+// Time is entirely under the control of the caller: millis() returns a
+// simulated clock, which only moves when advance_millis() is called, or by a
+// fixed step on every millis() call if one is configured.
+class Simulator : public Bus {
+  public:
+    // Data leaving a socket on SEND
+    struct Packet {
+        uint8_t socket;
+        SocketMode mode;
+        // Destination registers at the time of the send
+        const uint8_t *dest_ip;
+        uint16_t dest_port;
+        const uint8_t *data;
+        size_t size;
+    };
+    typedef void (*TransmitHandler)(Simulator &sim, const Packet &packet,
+                                    void *ctx);
+
+    struct Stats {
+        uint64_t transactions = 0;
+        uint64_t header_bytes = 0;
+        uint64_t data_bytes = 0;
+        uint64_t commands = 0;
+        uint64_t tx_bytes = 0;
+        uint64_t rx_bytes = 0;
+    };
+
+    static const size_t buffer_memory_size = 16 * 1024;
+    static const size_t max_paths = 8;
+
+    Simulator() { reset(); }
+    ~Simulator() override{};
+
+    //// Bus interface
+    uint64_t millis() override {
+        _now_ms += _millis_step;
+        run_timers();
+        return _now_ms;
+    }
+
+    void chip_select() override {
+        _selected = true;
+        _frame_offset = 0;
+        _stats.transactions++;
+    }
+
+    void chip_deselect() override { _selected = false; }
+
+    void spi_xfer(uint8_t send, uint8_t *recv) override {
+        *recv = clock_byte(send);
+    }
+
+    using Bus::spi_xfer;
+    void spi_xfer(const uint8_t *send, uint8_t *recv, size_t count) override {
+        // Clock out the header bytes one at a time
+        size_t i = 0;
+        while (i < count && _frame_offset < 3) {
+            const uint8_t byte = clock_byte(send != nullptr ? send[i] : 0);
+            if (recv != nullptr) {
+                recv[i] = byte;
+            }
+            i++;
+        }
+        if (i == count) {
+            return;
+        }
+        if (!_selected) {
+            if (recv != nullptr) {
+                memset(&recv[i], 0, count - i);
+            }
+            return;
+        }
+
+        // Buffer memory data phases are copied in runs up to the next wrap,
+        // everything else goes through the register model byte by byte
+        const uint8_t block = _control >> 3;
+        const bool write = _control & 0b100;
+        if (block != 0 && (block & 0b11) != 0b01) {
+            uint8_t *memory = nullptr;
+            size_t base = 0, size = 0;
+            const uint8_t socket = block >> 2;
+            if ((block & 0b11) == 0b10) {
+                memory = _tx_memory;
+                allocation(socket, true, base, size);
+            } else if ((block & 0b11) == 0b11) {
+                memory = _rx_memory;
+                allocation(socket, false, base, size);
+            }
+            if (memory == nullptr || size == 0) {
+                if (recv != nullptr) {
+                    memset(&recv[i], 0, count - i);
+                }
+                return;
+            }
+
+            _stats.data_bytes += count - i;
+            while (i < count) {
+                const size_t offset = _address & (size - 1);
+                size_t n = size - offset;
+                if (n > count - i) {
+                    n = count - i;
+                }
+                if (write) {
+                    if (send != nullptr) {
+                        memcpy(&memory[base + offset], &send[i], n);
+                    } else {
+                        memset(&memory[base + offset], 0, n);
+                    }
+                    if (recv != nullptr) {
+                        memset(&recv[i], 0, n);
+                    }
+                } else if (recv != nullptr) {
+                    memcpy(&recv[i], &memory[base + offset], n);
+                }
+                _address += n;
+                i += n;
+            }
+            return;
+        }
+
+        for (; i < count; i++) {
+            const uint8_t byte = clock_byte(send != nullptr ? send[i] : 0);
+            if (recv != nullptr) {
+                recv[i] = byte;
+            }
+        }
+    }
+
+    //// Simulation control
+    // Return every register and buffer to its power on state
+    void reset() {
+        memset(_common, 0, sizeof(_common));
+        _common[0x19] = 0x07; // RTR = 2000 (200ms)
+        _common[0x1A] = 0xD0;
+        _common[0x1B] = 0x08; // RCR
+        _common[0x1C] = 0x28; // PTIMER
+        _common[0x1D] = 0x00; // PMAGIC
+        _phy_config = 0b10111000;
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            reset_socket(socket);
+        }
+        memset(_tx_memory, 0, sizeof(_tx_memory));
+        memset(_rx_memory, 0, sizeof(_rx_memory));
+        _interrupt_line = false;
+    }
+
+    // Simulated time
+    void set_millis(uint64_t ms) {
+        _now_ms = ms;
+        run_timers();
+    }
+    void advance_millis(uint64_t ms) { set_millis(_now_ms + ms); }
+    // Advance the clock by this much every time millis() is called, so that
+    // code with timeouts makes progress without an external clock
+    void set_millis_step(uint64_t ms) { _millis_step = ms; }
+    uint64_t now_ms() const { return _now_ms; }
+
+    // Ethernet link state, as reported in PHYCFGR
+    void set_link_up(bool up) { _link_up = up; }
+
+    // Time for an outgoing TCP connection to be accepted by the simulated
+    // peer. If refused, CONNECT times out after that long instead.
+    void set_connect_latency(uint64_t ms) { _connect_latency_ms = ms; }
+    void set_refuse_connections(bool refuse) { _refuse_connections = refuse; }
+    // Round trip time to a destination, which delays both the completion of
+    // a CONNECT and the SEND_OK of each TCP send to it. If the round trip is
+    // longer than the retransmission timeout given by RTR and RCR when the
+    // command is issued, the socket times out instead. Returns false if
+    // there are already max_paths destinations.
+    bool set_path_latency(const uint8_t ip[4], uint64_t ms) {
+        for (size_t i = 0; i < max_paths; i++) {
+            if (i == _path_count || memcmp(_paths[i].ip, ip, 4) == 0) {
+                memcpy(_paths[i].ip, ip, 4);
+                _paths[i].latency_ms = ms;
+                _path_count += i == _path_count ? 1 : 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void set_transmit_handler(TransmitHandler handler, void *ctx) {
+        _transmit_handler = handler;
+        _transmit_ctx = ctx;
+    }
+
+    // Receive a UDP datagram on a socket in UDP mode. The datagram is
+    // stored with the 8 byte header the IC prepends (source IP, source port,
+    // length). Returns false if the socket is not open or out of space.
+    bool inject_udp(uint8_t socket, const uint8_t source_ip[4],
+                    uint16_t source_port, const uint8_t *data, size_t size) {
+        if (status(socket) != Registers::Socket::StatusValue::UDP ||
+            rx_free(socket) < size + 8) {
+            return false;
+        }
+        const uint8_t header[8] = {source_ip[0],
+                                   source_ip[1],
+                                   source_ip[2],
+                                   source_ip[3],
+                                   uint8_t(source_port >> 8),
+                                   uint8_t(source_port),
+                                   uint8_t(size >> 8),
+                                   uint8_t(size)};
+        rx_append(socket, header, sizeof(header));
+        rx_append(socket, data, size);
+        set_socket_interrupt(socket, Registers::Socket::InterruptFlags::RECV);
+        return true;
+    }
+
+    // Receive stream data on an established TCP socket. Returns the number
+    // of bytes that fit in the RX buffer.
+    size_t inject_tcp(uint8_t socket, const uint8_t *data, size_t size) {
+        const Registers::Socket::StatusValue state = status(socket);
+        if (state != Registers::Socket::StatusValue::ESTABLISHED) {
+            return 0;
+        }
+        const size_t free = rx_free(socket);
+        if (size > free) {
+            size = free;
+        }
+        if (size > 0) {
+            rx_append(socket, data, size);
+            set_socket_interrupt(socket,
+                                 Registers::Socket::InterruptFlags::RECV);
+        }
+        return size;
+    }
+
+    // Receive a raw ethernet frame on socket 0 in MACRAW mode. The frame is
+    // stored behind the 2 byte length header (including itself) the IC
+    // prepends.
+    bool inject_frame(const uint8_t *frame, size_t size) {
+        if (status(0) != Registers::Socket::StatusValue::MACRAW ||
+            rx_free(0) < size + 2) {
+            return false;
+        }
+        const uint8_t header[2] = {uint8_t((size + 2) >> 8),
+                                   uint8_t(size + 2)};
+        rx_append(0, header, sizeof(header));
+        rx_append(0, frame, size);
+        set_socket_interrupt(0, Registers::Socket::InterruptFlags::RECV);
+        return true;
+    }
+
+    // A remote client connects to a listening TCP socket
+    bool inject_connection(uint8_t socket, const uint8_t source_ip[4],
+                           uint16_t source_port) {
+        if (status(socket) != Registers::Socket::StatusValue::LISTEN) {
+            return false;
+        }
+        memcpy(&_socket[socket][0x0C], source_ip, 4);
+        _socket[socket][0x10] = source_port >> 8;
+        _socket[socket][0x11] = source_port & 0xFF;
+        set_status(socket, Registers::Socket::StatusValue::ESTABLISHED);
+        set_socket_interrupt(socket,
+                             Registers::Socket::InterruptFlags::CONNECT);
+        return true;
+    }
+
+    // The remote end of a TCP connection sends FIN
+    bool inject_disconnect(uint8_t socket) {
+        if (status(socket) != Registers::Socket::StatusValue::ESTABLISHED) {
+            return false;
+        }
+        set_status(socket, Registers::Socket::StatusValue::CLOSE_WAIT);
+        set_socket_interrupt(socket,
+                             Registers::Socket::InterruptFlags::DISCONNECT);
+        return true;
+    }
+
+    // The peer of an established TCP connection stops responding. The next
+    // SEND or keepalive goes unanswered, and the socket times out after the
+    // retransmission time given by RTR and RCR. If Sn_KPALVTR is set, the IC
+    // sends that keepalive itself once the interval has passed.
+    bool inject_peer_loss(uint8_t socket) {
+        if (status(socket) != Registers::Socket::StatusValue::ESTABLISHED) {
+            return false;
+        }
+        _state[socket].peer_lost = true;
+        const uint8_t keepalive_interval = _socket[socket][0x2F];
+        if (keepalive_interval > 0) {
+            start_retransmission(socket,
+                                 _now_ms + keepalive_interval * 5000ULL);
+        }
+        return true;
+    }
+
+    // Direct access to the model, for inspection by tests
+    Registers::Socket::StatusValue status(uint8_t socket) const {
+        return Registers::Socket::StatusValue(_socket[socket][0x03]);
+    }
+    uint8_t socket_register(uint8_t socket, uint8_t offset) {
+        return read_socket(socket, offset);
+    }
+    uint8_t common_register(uint8_t offset) { return read_common(offset); }
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    // Register files
+    uint8_t _common[0x40];
+    uint8_t _socket[max_sockets][Registers::Socket::block_size];
+    uint8_t _phy_config;
+    bool _link_up = true;
+
+    // Pointers that only the IC writes, or that only take effect on a
+    // command, kept outside the register file
+    struct SocketState {
+        uint16_t tx_read_pointer;
+        uint16_t rx_write_pointer;
+        // Read pointer as of the last RECV command
+        uint16_t rx_committed_pointer;
+        // Pending CONNECT completion, if connecting
+        uint64_t connect_deadline_ms;
+        // Pending SEND_OK, while a TCP send waits for its acknowledgement
+        uint64_t send_ok_deadline_ms;
+        // The peer has gone, and when the socket will time out if something
+        // has been sent to it
+        bool peer_lost;
+        uint64_t timeout_deadline_ms;
+    };
+    SocketState _state[max_sockets];
+
+    // Buffer memories
+    uint8_t _tx_memory[buffer_memory_size];
+    uint8_t _rx_memory[buffer_memory_size];
+
+    // Scratch space for unwrapping outgoing data
+    uint8_t _transmit_buffer[buffer_memory_size];
+
+    // Current SPI frame
+    bool _selected = false;
+    size_t _frame_offset = 0;
+    uint16_t _address = 0;
+    uint8_t _control = 0;
+
+    uint64_t _now_ms = 0;
+    uint64_t _millis_step = 0;
+    uint64_t _connect_latency_ms = 0;
+    bool _refuse_connections = false;
+    struct Path {
+        uint8_t ip[4];
+        uint64_t latency_ms;
+    };
+    Path _paths[max_paths];
+    size_t _path_count = 0;
+    bool _interrupt_line = false;
+
+    TransmitHandler _transmit_handler = nullptr;
+    void *_transmit_ctx = nullptr;
+
+    Stats _stats;
+
+    uint8_t clock_byte(uint8_t mosi) {
+        if (!_selected) {
+            return 0;
+        }
+
+        // Address and control phase
+        if (_frame_offset < 3) {
+            switch (_frame_offset++) {
+            case 0:
+                _address = mosi << 8;
+                break;
+            case 1:
+                _address |= mosi;
+                break;
+            case 2:
+                _control = mosi;
+                break;
+            }
+            _stats.header_bytes++;
+            return 0;
+        }
+
+        // Data phase, auto incrementing the address
+        _stats.data_bytes++;
+        const uint8_t block = _control >> 3;
+        const bool write = _control & 0b100;
+        const uint16_t address = _address++;
+        if (write) {
+            write_block(block, address, mosi);
+            return 0;
+        }
+        return read_block(block, address);
+    }
+
+    uint8_t read_block(uint8_t block, uint16_t address) {
+        if (block == COMMON_REGISTER_BANK) {
+            return read_common(address);
+        }
+        const uint8_t socket = block >> 2;
+        size_t base, size;
+        switch (block & 0b11) {
+        case 0b01:
+            return read_socket(socket, address);
+        case 0b10:
+            allocation(socket, true, base, size);
+            return size ? _tx_memory[base + (address & (size - 1))] : 0;
+        case 0b11:
+            allocation(socket, false, base, size);
+            return size ? _rx_memory[base + (address & (size - 1))] : 0;
+        }
+        return 0;
+    }
+
+    void write_block(uint8_t block, uint16_t address, uint8_t value) {
+        if (block == COMMON_REGISTER_BANK) {
+            write_common(address, value);
+            return;
+        }
+        const uint8_t socket = block >> 2;
+        size_t base, size;
+        switch (block & 0b11) {
+        case 0b01:
+            write_socket(socket, address, value);
+            break;
+        case 0b10:
+            allocation(socket, true, base, size);
+            if (size) {
+                _tx_memory[base + (address & (size - 1))] = value;
+            }
+            break;
+        case 0b11:
+            allocation(socket, false, base, size);
+            if (size) {
+                _rx_memory[base + (address & (size - 1))] = value;
+            }
+            break;
+        }
+    }
+
+    uint8_t read_common(uint16_t address) {
+        switch (address) {
+        case 0x17: {
+            // SIR: one bit per socket with an unmasked interrupt pending
+            uint8_t value = 0;
+            for (uint8_t socket = 0; socket < max_sockets; socket++) {
+                if (_socket[socket][0x02] & _socket[socket][0x2C]) {
+                    value |= 1 << socket;
+                }
+            }
+            return value;
+        }
+        case 0x2E:
+            return _phy_config | (_link_up ? 0b111 : 0);
+        case 0x39:
+            return 0x04;
+        default:
+            return address < sizeof(_common) ? _common[address] : 0;
+        }
+    }
+
+    void write_common(uint16_t address, uint8_t value) {
+        switch (address) {
+        case 0x00:
+            if (value & static_cast<uint8_t>(
+                            Registers::Common::ModeFlags::RESET)) {
+                reset();
+            } else {
+                _common[0x00] = value;
+            }
+            break;
+        case 0x15:
+            // IR is write 1 to clear
+            _common[0x15] &= ~value;
+            update_interrupt_line();
+            break;
+        case 0x16:
+        case 0x18:
+            _common[address] = value;
+            update_interrupt_line();
+            break;
+        case 0x17:
+        case 0x39:
+            // Read only
+            break;
+        case 0x2E:
+            // Writing RST low resets the PHY, which reads back high once
+            // done. Only the operation mode bits are stored.
+            _phy_config = 0x80 | (value & 0b01111000);
+            break;
+        default:
+            if (address < sizeof(_common)) {
+                _common[address] = value;
+            }
+            break;
+        }
+    }
+
+    uint8_t read_socket(uint8_t socket, uint16_t address) {
+        const SocketState &state = _state[socket];
+        switch (address) {
+        case 0x01:
+            // Command register reads back zero once accepted
+            return 0;
+        case 0x20:
+            return tx_free(socket) >> 8;
+        case 0x21:
+            return tx_free(socket) & 0xFF;
+        case 0x22:
+            return state.tx_read_pointer >> 8;
+        case 0x23:
+            return state.tx_read_pointer & 0xFF;
+        case 0x26:
+            return rx_received(socket) >> 8;
+        case 0x27:
+            return rx_received(socket) & 0xFF;
+        case 0x2A:
+            return state.rx_write_pointer >> 8;
+        case 0x2B:
+            return state.rx_write_pointer & 0xFF;
+        default:
+            return address < Registers::Socket::block_size
+                       ? _socket[socket][address]
+                       : 0;
+        }
+    }
+
+    void write_socket(uint8_t socket, uint16_t address, uint8_t value) {
+        switch (address) {
+        case 0x01:
+            command(socket, Registers::Socket::CommandValue(value));
+            break;
+        case 0x02:
+            // Sn_IR is write 1 to clear
+            _socket[socket][0x02] &= ~value;
+            update_interrupt_line();
+            break;
+        case 0x2C:
+            _socket[socket][0x2C] = value;
+            update_interrupt_line();
+            break;
+        case 0x03:
+        case 0x20:
+        case 0x21:
+        case 0x22:
+        case 0x23:
+        case 0x26:
+        case 0x27:
+        case 0x2A:
+        case 0x2B:
+            // Read only
+            break;
+        default:
+            if (address < Registers::Socket::block_size) {
+                _socket[socket][address] = value;
+            }
+            break;
+        }
+    }
+
+    void reset_socket(uint8_t socket) {
+        uint8_t *regs = _socket[socket];
+        memset(regs, 0, Registers::Socket::block_size);
+        memset(&regs[0x06], 0xFF, 6); // DHAR
+        regs[0x15] = 0x00;            // TOS
+        regs[0x16] = 0x80;            // TTL
+        regs[0x1E] = 0x02;            // RXBUF_SIZE
+        regs[0x1F] = 0x02;            // TXBUF_SIZE
+        regs[0x2C] = 0xFF;            // IMR
+        regs[0x2D] = 0x40;            // FRAG
+        _state[socket] = SocketState();
+        set_status(socket, Registers::Socket::StatusValue::CLOSED);
+    }
+
+    void command(uint8_t socket, Registers::Socket::CommandValue cmd) {
+        using Registers::Socket::CommandValue;
+        using Registers::Socket::StatusValue;
+        _stats.commands++;
+        const StatusValue state = status(socket);
+        switch (cmd) {
+        case CommandValue::OPEN:
+            open(socket);
+            break;
+        case CommandValue::LISTEN:
+            if (state == StatusValue::INIT) {
+                set_status(socket, StatusValue::LISTEN);
+            }
+            break;
+        case CommandValue::CONNECT:
+            if (state == StatusValue::INIT) {
+                const uint64_t latency =
+                    path_latency(socket, _connect_latency_ms);
+                set_status(socket, StatusValue::SYN_SENT);
+                _state[socket].connect_deadline_ms = _now_ms + latency;
+                if (latency >= retransmission_timeout_ms()) {
+                    start_retransmission(socket, _now_ms);
+                }
+                run_timers();
+            }
+            break;
+        case CommandValue::DISCONNECT:
+            if (state == StatusValue::ESTABLISHED ||
+                state == StatusValue::CLOSE_WAIT) {
+                set_status(socket, StatusValue::CLOSED);
+                cancel_timers(socket);
+                set_socket_interrupt(
+                    socket, Registers::Socket::InterruptFlags::DISCONNECT);
+            }
+            break;
+        case CommandValue::CLOSE:
+            set_status(socket, StatusValue::CLOSED);
+            cancel_timers(socket);
+            break;
+        case CommandValue::SEND:
+        case CommandValue::SEND_MAC:
+            if (_state[socket].peer_lost) {
+                start_retransmission(socket, _now_ms);
+            } else if (state == StatusValue::ESTABLISHED ||
+                       state == StatusValue::CLOSE_WAIT) {
+                const uint64_t latency = path_latency(socket, 0);
+                if (latency >= retransmission_timeout_ms()) {
+                    start_retransmission(socket, _now_ms);
+                } else if (!transmit(socket)) {
+                    break;
+                } else if (latency > 0) {
+                    _state[socket].send_ok_deadline_ms = _now_ms + latency;
+                } else {
+                    set_socket_interrupt(
+                        socket, Registers::Socket::InterruptFlags::SEND_OK);
+                }
+            } else if (state == StatusValue::UDP ||
+                       state == StatusValue::MACRAW) {
+                if (transmit(socket)) {
+                    set_socket_interrupt(
+                        socket, Registers::Socket::InterruptFlags::SEND_OK);
+                }
+            }
+            break;
+        case CommandValue::SEND_KEEPALIVE:
+            if (_state[socket].peer_lost) {
+                start_retransmission(socket, _now_ms);
+            }
+            break;
+        case CommandValue::RECV:
+            _state[socket].rx_committed_pointer = read_u16(socket, 0x28);
+            break;
+        }
+    }
+
+    void open(uint8_t socket) {
+        using Registers::Socket::StatusValue;
+        StatusValue next;
+        switch (SocketMode(_socket[socket][0x00] & 0x0F)) {
+        case SocketMode::TCP:
+            next = StatusValue::INIT;
+            break;
+        case SocketMode::UDP:
+            next = StatusValue::UDP;
+            break;
+        case SocketMode::MACRAW:
+            if (socket != 0) {
+                return;
+            }
+            next = StatusValue::MACRAW;
+            break;
+        default:
+            return;
+        }
+
+        // Pointers all start back at zero
+        SocketState &state = _state[socket];
+        state = SocketState();
+        write_u16(socket, 0x24, 0);
+        write_u16(socket, 0x28, 0);
+        set_status(socket, next);
+    }
+
+    // Hand the data between the TX pointers to the transmit handler.
+    // Returns false if the socket has no TX memory for it.
+    bool transmit(uint8_t socket) {
+        SocketState &state = _state[socket];
+        const uint16_t write_pointer = read_u16(socket, 0x24);
+        const uint16_t size = write_pointer - state.tx_read_pointer;
+
+        size_t base, alloc;
+        allocation(socket, true, base, alloc);
+        if (alloc == 0 || size > alloc) {
+            return false;
+        }
+        for (uint16_t i = 0; i < size; i++) {
+            _transmit_buffer[i] =
+                _tx_memory[base + ((state.tx_read_pointer + i) & (alloc - 1))];
+        }
+        state.tx_read_pointer = write_pointer;
+        _stats.tx_bytes += size;
+
+        if (_transmit_handler != nullptr) {
+            Packet packet;
+            packet.socket = socket;
+            packet.mode = SocketMode(_socket[socket][0x00] & 0x0F);
+            packet.dest_ip = &_socket[socket][0x0C];
+            packet.dest_port = read_u16(socket, 0x10);
+            packet.data = _transmit_buffer;
+            packet.size = size;
+            _transmit_handler(*this, packet, _transmit_ctx);
+        }
+        return true;
+    }
+
+    void run_timers() {
+        using Registers::Socket::StatusValue;
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            SocketState &state = _state[socket];
+            if (state.timeout_deadline_ms != 0 &&
+                state.timeout_deadline_ms <= _now_ms) {
+                state.timeout_deadline_ms = 0;
+                if (status(socket) == StatusValue::CLOSED) {
+                    continue;
+                }
+                set_status(socket, StatusValue::CLOSED);
+                cancel_timers(socket);
+                set_socket_interrupt(
+                    socket, Registers::Socket::InterruptFlags::TIMEOUT);
+                continue;
+            }
+            if (state.send_ok_deadline_ms != 0 &&
+                state.send_ok_deadline_ms <= _now_ms) {
+                state.send_ok_deadline_ms = 0;
+                set_socket_interrupt(
+                    socket, Registers::Socket::InterruptFlags::SEND_OK);
+            }
+            if (status(socket) != StatusValue::SYN_SENT ||
+                _state[socket].connect_deadline_ms > _now_ms) {
+                continue;
+            }
+            if (_refuse_connections) {
+                set_status(socket, StatusValue::CLOSED);
+                cancel_timers(socket);
+                set_socket_interrupt(
+                    socket, Registers::Socket::InterruptFlags::TIMEOUT);
+            } else {
+                set_status(socket, StatusValue::ESTABLISHED);
+                set_socket_interrupt(
+                    socket, Registers::Socket::InterruptFlags::CONNECT);
+            }
+        }
+    }
+
+    // Forget any pending completion of a socket that has closed, so that
+    // nothing is raised on it, or on whatever it is next opened as
+    void cancel_timers(uint8_t socket) {
+        SocketState &state = _state[socket];
+        state.connect_deadline_ms = 0;
+        state.send_ok_deadline_ms = 0;
+        state.timeout_deadline_ms = 0;
+    }
+
+    // Round trip time to a socket's destination, if one has been set
+    uint64_t path_latency(uint8_t socket, uint64_t otherwise) const {
+        for (size_t i = 0; i < _path_count; i++) {
+            if (memcmp(_paths[i].ip, &_socket[socket][0x0C], 4) == 0) {
+                return _paths[i].latency_ms;
+            }
+        }
+        return otherwise;
+    }
+
+    // Time for an unanswered segment to time out, from RTR and RCR
+    uint64_t retransmission_timeout_ms() const {
+        const uint16_t retry_time = _common[0x19] << 8 | _common[0x1A];
+        // In units of 100us, rounded up to whole milliseconds
+        const uint32_t timeout =
+            Registers::Common::tcp_timeout(retry_time, _common[0x1B]);
+        return (timeout + 9) / 10;
+    }
+
+    // Start the retransmission timer of a socket whose peer has gone
+    void start_retransmission(uint8_t socket, uint64_t from_ms) {
+        SocketState &state = _state[socket];
+        if (state.timeout_deadline_ms == 0) {
+            state.timeout_deadline_ms = from_ms + retransmission_timeout_ms();
+        }
+        run_timers();
+    }
+
+    void set_status(uint8_t socket, Registers::Socket::StatusValue value) {
+        _socket[socket][0x03] = static_cast<uint8_t>(value);
+    }
+
+    void set_socket_interrupt(uint8_t socket,
+                              Registers::Socket::InterruptFlags flag) {
+        _socket[socket][0x02] |= static_cast<uint8_t>(flag);
+        update_interrupt_line();
+    }
+
+    // Drive the simulated INTn pin, raising the bus interrupt on an edge
+    void update_interrupt_line() {
+        const bool asserted = (_common[0x15] & _common[0x16]) ||
+                              (read_common(0x17) & _common[0x18]);
+        if (asserted && !_interrupt_line) {
+            trigger_interrupt();
+        }
+        _interrupt_line = asserted;
+    }
+
+    // Locate a socket's share of the TX or RX memory. Sockets are allocated
+    // in order; any socket that doesn't fit in the 16KB gets no memory.
+    void allocation(uint8_t socket, bool tx, size_t &base, size_t &size) {
+        const uint8_t reg = tx ? 0x1F : 0x1E;
+        base = 0;
+        for (uint8_t i = 0; i < socket; i++) {
+            base += _socket[i][reg] * 1024;
+        }
+        size = _socket[socket][reg] * 1024;
+        // Only power of two sizes are valid
+        if ((size & (size - 1)) != 0 || base + size > buffer_memory_size) {
+            size = 0;
+        }
+    }
+
+    uint16_t tx_free(uint8_t socket) {
+        size_t base, size;
+        allocation(socket, true, base, size);
+        const uint16_t used =
+            read_u16(socket, 0x24) - _state[socket].tx_read_pointer;
+        return used < size ? size - used : 0;
+    }
+
+    uint16_t rx_received(uint8_t socket) {
+        return _state[socket].rx_write_pointer -
+               _state[socket].rx_committed_pointer;
+    }
+
+    size_t rx_free(uint8_t socket) {
+        size_t base, size;
+        allocation(socket, false, base, size);
+        const uint16_t used = rx_received(socket);
+        return used < size ? size - used : 0;
+    }
+
+    void rx_append(uint8_t socket, const uint8_t *data, size_t size) {
+        size_t base, alloc;
+        allocation(socket, false, base, alloc);
+        SocketState &state = _state[socket];
+        for (size_t i = 0; i < size; i++) {
+            _rx_memory[base + ((state.rx_write_pointer + i) & (alloc - 1))] =
+                data[i];
+        }
+        state.rx_write_pointer += size;
+        _stats.rx_bytes += size;
+    }
+
+    uint16_t read_u16(uint8_t socket, uint8_t offset) const {
+        return _socket[socket][offset] << 8 | _socket[socket][offset + 1];
+    }
+
+    void write_u16(uint8_t socket, uint8_t offset, uint16_t value) {
+        _socket[socket][offset] = value >> 8;
+        _socket[socket][offset + 1] = value & 0xFF;
+    }
+};
+
+} // namespace Buses
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_BUSES_SIMULATOR_H_
@@ -0,0 +1,96 @@
+#ifndef _W5500__W5500_FRAMERING_H_
+#define _W5500__W5500_FRAMERING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace W5500 {
+
+// An ethernet frame held in a FrameRing
+struct CapturedFrame {
+    // Time the frame was taken from the IC
+    uint32_t seconds;
+    uint32_t microseconds;
+    // Length on the wire, and how much of it was kept
+    uint16_t length;
+    uint16_t captured;
+    const uint8_t *data;
+};
+
+// Supplies the time for captured frames
+typedef void (*CaptureClock)(uint32_t &seconds, uint32_t &microseconds,
+                             void *ctx);
+
+// Fixed size ring of captured frames, filled by MacRawSocket::capture and
+// emptied by the application or a PcapWriter. Storage is provided by the
+// caller: slot_count frame descriptors, and slot_count slots of slot_size
+// bytes for the frame data. Frames longer than a slot are truncated, so the
+// slot size sets the snap length.
+class FrameRing {
+  public:
+    // Each slot begins with the 2 byte length header the IC puts in front of
+    // every MACRAW frame, so that frames can be read straight into a slot
+    static const size_t header_size = 2;
+
+    FrameRing(CapturedFrame *frames, uint8_t *storage, size_t slot_count,
+              size_t slot_size)
+        : _frames(frames), _storage(storage), _slot_count(slot_count),
+          _slot_size(slot_size) {}
+
+    size_t capacity() const { return _slot_count; }
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    bool full() const { return _count == _slot_count; }
+    size_t slot_size() const { return _slot_size; }
+    // Longest frame kept whole
+    size_t snap_length() const { return _slot_size - header_size; }
+
+    // Oldest frame. Only valid while the ring is not empty.
+    const CapturedFrame &front() const { return _frames[_head]; }
+    void pop() {
+        if (_count > 0) {
+            _head = (_head + 1) % _slot_count;
+            _count--;
+        }
+    }
+    void clear() {
+        _head = 0;
+        _count = 0;
+    }
+
+    //// Producer side
+
+    // Slot the next frame is stored in. Only valid while the ring is not
+    // full.
+    uint8_t *next_slot() {
+        return &_storage[((_head + _count) % _slot_count) * _slot_size];
+    }
+
+    // Add the frame in next_slot() to the ring
+    void push(uint16_t length, uint16_t captured, uint32_t seconds,
+              uint32_t microseconds) {
+        CapturedFrame &frame = _frames[(_head + _count) % _slot_count];
+        frame.seconds = seconds;
+        frame.microseconds = microseconds;
+        frame.length = length;
+        frame.captured = captured;
+        frame.data = next_slot() + header_size;
+        _count++;
+    }
+
+  private:
+    CapturedFrame *const _frames;
+    uint8_t *const _storage;
+    const size_t _slot_count;
+    const size_t _slot_size;
+    size_t _head = 0;
+    size_t _count = 0;
+
+    // Disallow copying
+    FrameRing(const FrameRing &);
+    FrameRing &operator=(const FrameRing &);
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_FRAMERING_H_
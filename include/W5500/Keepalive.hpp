@@ -0,0 +1,90 @@
+#ifndef _W5500__W5500_KEEPALIVE_H_
+#define _W5500__W5500_KEEPALIVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+
+// Detects dead TCP peers quickly, by probing idle connections with
+// keepalives and tightening the IC's retransmission timeout.
+//
+// With the chip defaults (200ms retry time, 8 retries) an unanswered segment
+// takes 31.8 seconds to time out, and the IC's own keepalive interval is in
+// steps of 5 seconds. The monitor instead checks each watched socket once per
+// idle interval of its own choosing: if no data has moved since the last
+// check, it sends a keepalive, which times out after the retransmission
+// timeout if the peer has gone. The retransmission settings are global to the
+// IC, so they apply to every socket. They are read back for each probe, so
+// the monitor keeps up with anything else that reprograms them, such as an
+// RttEstimator.
+//
+// A dead peer is therefore reported at most twice the idle interval plus the
+// retransmission timeout after the last traffic. Each check is a single burst
+// read.
+class KeepaliveMonitor {
+  public:
+    // Called when a watched socket has timed out, or otherwise closed
+    // without the application closing it
+    typedef void (*DeadPeerCallback)(uint8_t socket, void *ctx);
+
+    struct Stats {
+        uint32_t checks = 0;
+        uint32_t keepalives = 0;
+        uint32_t dead_peers = 0;
+    };
+
+    explicit KeepaliveMonitor(W5500 &driver) : _driver(driver) {}
+
+    // Set the IC's retransmission timing (retry time in units of 100us).
+    // Returns the resulting timeout in milliseconds.
+    uint32_t set_retransmission(uint16_t retry_time, uint8_t retry_count);
+    // Timeout for an unacknowledged segment, in milliseconds
+    uint32_t retransmission_timeout_ms();
+
+    void set_callback(DeadPeerCallback callback, void *ctx) {
+        _callback = callback;
+        _callback_ctx = ctx;
+    }
+
+    // Probe a socket after idle_ms without traffic. Watch a socket once it
+    // is connected; the IC only sends keepalives once at least one byte has
+    // been exchanged. Stop watching (idle time 0) before closing it.
+    void watch(uint8_t socket, uint32_t idle_ms);
+    void unwatch(uint8_t socket) { watch(socket, 0); }
+    bool watching(uint8_t socket) const { return _watches[socket].idle_ms > 0; }
+
+    // Check any sockets that are due
+    void poll();
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    struct Watch {
+        uint32_t idle_ms = 0;
+        uint64_t next_check_ms = 0;
+        // Pointers as of the last check, which move with any traffic
+        uint16_t tx_read_pointer = 0;
+        uint16_t rx_write_pointer = 0;
+        // A keepalive is waiting to be answered
+        bool probing = false;
+    };
+
+    W5500 &_driver;
+    Watch _watches[max_sockets];
+
+    DeadPeerCallback _callback = nullptr;
+    void *_callback_ctx = nullptr;
+    Stats _stats;
+
+    // Disallow copying
+    KeepaliveMonitor(const KeepaliveMonitor &);
+    KeepaliveMonitor &operator=(const KeepaliveMonitor &);
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_KEEPALIVE_H_
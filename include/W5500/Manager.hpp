@@ -0,0 +1,84 @@
+#ifndef _W5500__W5500_MANAGER_H_
+#define _W5500__W5500_MANAGER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+
+// A hardware socket on one of the chips owned by a Manager
+struct SocketHandle {
+    W5500 *driver = nullptr;
+    uint8_t chip = 0;
+    uint8_t socket = 0;
+
+    bool valid() const { return driver != nullptr; }
+    // Index into the manager's global socket pool
+    size_t id() const { return chip * max_sockets + socket; }
+};
+
+// Manager for several W5500s, to go beyond eight sockets and one link.
+// Chips may each have their own bus, or share one SPI peripheral through
+// Buses::SharedSpi. Sockets are handed out from a single pool covering all
+// chips, spreading them over the least loaded chip so that traffic is
+// balanced across links. The handle gives the driver and socket number to
+// construct a Socket on:
+//
+//     SocketHandle handle = manager.allocate();
+//     UdpSocket socket(*handle.driver, handle.socket);
+//
+// poll() reads back the state of every allocated socket with one burst read
+// per socket, rather than a transaction per register, visiting the chips in
+// rotation so that no chip is always served first.
+class Manager {
+  public:
+    static const size_t max_chips = 4;
+
+    // Called by poll() for each allocated socket
+    typedef void (*SocketCallback)(const SocketHandle &handle,
+                                   const SocketSnapshot &snapshot, void *ctx);
+
+    Manager() {}
+
+    // Add a chip to the pool. Returns its index, or -1 if the manager is full.
+    int add_chip(W5500 &driver);
+    size_t chip_count() const { return _chip_count; }
+    W5500 &chip(size_t index) { return *_chips[index]; }
+
+    // Socket pool
+    size_t socket_count() const { return _chip_count * max_sockets; }
+    size_t free_sockets() const;
+    bool in_use(size_t id) const;
+    // Take a free socket from the least loaded chip. Returns an invalid
+    // handle if every socket is taken.
+    SocketHandle allocate();
+    // Take a free socket from a specific chip
+    SocketHandle allocate_on(size_t chip);
+    // Return a socket to the pool. The socket should be closed first.
+    // Handles that don't belong to this manager are ignored.
+    void release(const SocketHandle &handle);
+    SocketHandle handle(size_t id) const;
+
+    // Snapshot every allocated socket
+    void poll(SocketCallback callback, void *ctx);
+
+  private:
+    W5500 *_chips[max_chips];
+    // Bitmask of allocated sockets, per chip
+    uint8_t _in_use[max_chips];
+    size_t _chip_count = 0;
+    // Chip that poll() starts from
+    size_t _next_chip = 0;
+
+    // Disallow copying
+    Manager(const Manager &);
+    Manager &operator=(const Manager &);
+
+    static size_t sockets_used(uint8_t mask);
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_MANAGER_H_
@@ -0,0 +1,104 @@
+#ifndef _W5500__W5500_PCAP_H_
+#define _W5500__W5500_PCAP_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <W5500/FrameRing.hpp>
+
+namespace W5500 {
+
+// Writes captured frames out in the classic pcap file format, readable by
+// Wireshark and tcpdump, through a sink supplied by the application (a file,
+// a UART, a TCP socket to a collector, ...). Fields are written in host byte
+// order, which the format allows.
+class PcapWriter {
+  public:
+    // Write size bytes. Return false if they could not be written, having
+    // written none of them: each call must be all or nothing.
+    typedef bool (*Sink)(const uint8_t *data, size_t size, void *ctx);
+
+    static const uint32_t magic = 0xA1B2C3D4;
+    static const uint32_t linktype_ethernet = 1;
+
+    PcapWriter(Sink sink, void *ctx) : _sink(sink), _ctx(ctx) {}
+
+    // Write the file header. Must be written once before any frames.
+    bool write_header(uint32_t snap_length = 65535) {
+        uint8_t header[24];
+        put(&header[0], magic);
+        put16(&header[4], 2); // Version 2.4
+        put16(&header[6], 4);
+        put(&header[8], 0);  // Timezone offset
+        put(&header[12], 0); // Timestamp accuracy
+        put(&header[16], snap_length);
+        put(&header[20], linktype_ethernet);
+        return emit(header, sizeof(header));
+    }
+
+    // Write one frame's record. If the sink fails, call again with the same
+    // frame: a record whose header has already gone out resumes with the
+    // frame data, so the file never holds a header twice.
+    bool write_frame(const CapturedFrame &frame) {
+        if (!_in_record) {
+            uint8_t header[16];
+            put(&header[0], frame.seconds);
+            put(&header[4], frame.microseconds);
+            put(&header[8], frame.captured);
+            put(&header[12], frame.length);
+            if (!emit(header, sizeof(header))) {
+                return false;
+            }
+            _in_record = true;
+        }
+        if (!emit(frame.data, frame.captured)) {
+            return false;
+        }
+        _in_record = false;
+        return true;
+    }
+
+    // Write out frames from a ring, releasing each once written. Returns
+    // the number of frames written; stops early if the sink fails, leaving
+    // the frame in the ring for the next call to finish.
+    size_t drain(FrameRing &ring, size_t max_frames = SIZE_MAX) {
+        size_t written = 0;
+        while (written < max_frames && !ring.empty()) {
+            if (!write_frame(ring.front())) {
+                break;
+            }
+            ring.pop();
+            written++;
+        }
+        return written;
+    }
+
+    uint64_t bytes_written() const { return _bytes_written; }
+
+  private:
+    Sink _sink;
+    void *_ctx;
+    uint64_t _bytes_written = 0;
+    // The current record's header has been written, but not its data
+    bool _in_record = false;
+
+    static void put(uint8_t *buffer, uint32_t value) {
+        memcpy(buffer, &value, sizeof(value));
+    }
+    static void put16(uint8_t *buffer, uint16_t value) {
+        memcpy(buffer, &value, sizeof(value));
+    }
+
+    bool emit(const uint8_t *data, size_t size) {
+        if (!_sink(data, size, _ctx)) {
+            return false;
+        }
+        _bytes_written += size;
+        return true;
+    }
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_PCAP_H_
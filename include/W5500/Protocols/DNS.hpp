@@ -128,6 +128,10 @@ class Client {
     }
 
     void update();
+    // Handle any responses that have arrived, whatever the state of the
+    // socket's interrupt flags. For use from a Reactor handler registered
+    // for RECV, which has already cleared the flag update() looks for.
+    void receive();
     bool query(const char *hostname, uint16_t *query_id_out);
     bool get(uint16_t query_id, uint8_t ip[4]);
     void set_server_ip(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
@@ -0,0 +1,81 @@
+#ifndef _W5500__W5500_REACTOR_H_
+#define _W5500__W5500_REACTOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+
+// Dispatches socket events to handlers, from the IC's socket interrupt
+// register rather than by polling every socket.
+//
+// One read of SIR shows which sockets have events. Only those sockets' flag
+// registers are read, each is cleared with a single write, and the flags are
+// passed to the socket's handler. With the INTn pin wired to an interrupt
+// that calls Bus::trigger_interrupt(), poll() does no SPI traffic at all
+// until something happens; without it, an idle poll() costs one read.
+//
+// Each handler is registered for a set of Registers::Socket::InterruptFlags.
+// The reactor owns those flags for that socket: they are cleared before the
+// handler runs, so code that waits on them itself (such as a SendStream and
+// SEND_OK) should not be registered for them. Flags outside the set are left
+// alone and don't wake the reactor.
+class Reactor {
+  public:
+    // Called with the flags that were set, out of those registered for
+    typedef void (*Handler)(uint8_t socket, uint8_t flags, void *ctx);
+
+    static const uint8_t all_events = 0x1F;
+
+    struct Stats {
+        // Calls to poll(), and those that read SIR
+        uint32_t polls = 0;
+        uint32_t wakeups = 0;
+        uint32_t dispatches = 0;
+        // Wakeups that found no socket event
+        uint32_t spurious = 0;
+    };
+
+    explicit Reactor(W5500 &driver) : _driver(driver) {}
+
+    // Register a handler, and enable interrupts for those events on the IC
+    void attach(uint8_t socket, Handler handler, void *ctx,
+                uint8_t events = all_events);
+    void detach(uint8_t socket);
+
+    // Whether the INTn line is connected. If so, poll() only talks to the IC
+    // after Bus::trigger_interrupt(); otherwise it reads SIR every time.
+    void set_interrupt_driven(bool interrupt_driven) {
+        _interrupt_driven = interrupt_driven;
+    }
+
+    // Handle every pending event. Returns the number of handler calls.
+    int poll();
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    struct Registration {
+        Handler handler = nullptr;
+        void *ctx = nullptr;
+        uint8_t events = 0;
+    };
+
+    W5500 &_driver;
+    Registration _handlers[max_sockets];
+    // Sockets with a handler, as written to SIMR
+    uint8_t _enabled = 0;
+    bool _interrupt_driven = false;
+    Stats _stats;
+
+    // Disallow copying
+    Reactor(const Reactor &);
+    Reactor &operator=(const Reactor &);
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_REACTOR_H_
@@ -0,0 +1,154 @@
+#ifndef _W5500__W5500_REGISTERCACHE_H_
+#define _W5500__W5500_REGISTERCACHE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <W5500/Registers.hpp>
+
+namespace W5500 {
+
+// Write-through shadow copies of configuration registers.
+//
+// Only registers that are never modified by the IC itself may be cached:
+//
+//   Common: GatewayAddress, SubnetMaskAddress, SourceHardwareAddress,
+//           SourceIpAddress, InterruptLevel, InterruptMask,
+//           SocketInterruptMask, RetryTime, RetryCount
+//   Socket: Mode, SourcePort, RxBufferSize, TxBufferSize, InterruptMask,
+//           KeepAliveTimer
+//
+// Everything else is volatile and always goes to the chip. In particular:
+// the common Mode register (RESET self-clears), Interrupt, SocketInterrupt
+// and PhyConfig; the socket Command, Interrupt and Status registers; all of
+// the TX/RX size and pointer registers; and the socket DestIPAddress,
+// DestPort, DestHardwareAddress and MaxSegmentSize registers, which the IC
+// fills in when a connection is accepted in server mode.
+class RegisterCache {
+  public:
+    // Look up a cached register. Returns true and copies the value out if
+    // the register is cacheable and a valid copy is held.
+    bool read(const CommonRegister &reg, uint8_t *data) {
+        if (!common_cacheable(reg) || !common_valid(reg)) {
+            return false;
+        }
+        memcpy(data, &_common[reg.offset], reg.size);
+        return true;
+    }
+
+    bool read(const SocketRegister &reg, uint8_t socket, uint8_t *data) {
+        const int slot = socket_slot(reg);
+        if (slot < 0 || !(_socket_valid[socket] & (1 << slot))) {
+            return false;
+        }
+        memcpy(data, &_socket[socket][socket_slot_offset(slot)], reg.size);
+        return true;
+    }
+
+    // Store a register value that has been read from or written to the IC.
+    // Does nothing for volatile registers.
+    void store(const CommonRegister &reg, const uint8_t *data) {
+        if (!common_cacheable(reg)) {
+            return;
+        }
+        memcpy(&_common[reg.offset], data, reg.size);
+        _common_valid |= range_mask(reg);
+    }
+
+    void store(const SocketRegister &reg, uint8_t socket,
+               const uint8_t *data) {
+        const int slot = socket_slot(reg);
+        if (slot < 0) {
+            return;
+        }
+        memcpy(&_socket[socket][socket_slot_offset(slot)], data, reg.size);
+        _socket_valid[socket] |= (1 << slot);
+    }
+
+    // Fill the cache from burst reads of the common register block
+    // (starting at 0x00, at least common_size bytes) or a socket register
+    // block.
+    void load_common(const uint8_t *block) {
+        memcpy(_common, block, common_size);
+        _common_valid = common_cacheable_mask;
+    }
+
+    void load_socket(uint8_t socket, const uint8_t *block) {
+        for (uint8_t slot = 0; slot < socket_slots; slot++) {
+            // Source port is the only two byte register
+            memcpy(&_socket[socket][socket_slot_offset(slot)],
+                   &block[slot_register(slot)], slot == 1 ? 2 : 1);
+        }
+        _socket_valid[socket] = (1 << socket_slots) - 1;
+    }
+
+    // Drop all cached values, e.g. after a chip reset
+    void invalidate() {
+        _common_valid = 0;
+        memset(_socket_valid, 0, sizeof(_socket_valid));
+    }
+
+    // Common registers 0x00 - 0x1B
+    static const uint8_t common_size = 0x1C;
+
+  private:
+    // Bytes of the common block that are never written by the IC:
+    // GAR, SUBR, SHAR, SIPR, INTLEVEL, IMR, SIMR, RTR, RCR
+    static const uint32_t common_cacheable_mask = 0x0FFFFFFE & ~(1 << 0x15) &
+                                                  ~(1 << 0x17);
+
+    // Per socket: Mode, SourcePort (2), RxBufferSize, TxBufferSize,
+    // InterruptMask, KeepAliveTimer
+    static const uint8_t socket_slots = 6;
+    static const uint8_t socket_size = 7;
+
+    uint8_t _common[common_size];
+    uint32_t _common_valid = 0;
+
+    uint8_t _socket[max_sockets][socket_size];
+    uint8_t _socket_valid[max_sockets] = {0};
+
+    static uint32_t range_mask(const Register &reg) {
+        return ((1UL << reg.size) - 1) << reg.offset;
+    }
+
+    static bool common_cacheable(const CommonRegister &reg) {
+        return reg.offset + reg.size <= common_size &&
+               (range_mask(reg) & common_cacheable_mask) == range_mask(reg);
+    }
+
+    bool common_valid(const CommonRegister &reg) const {
+        return (_common_valid & range_mask(reg)) == range_mask(reg);
+    }
+
+    // Register offset held in each slot
+    static uint8_t slot_register(uint8_t slot) {
+        static const uint8_t registers[socket_slots] = {
+            0x00, // Mode
+            0x04, // SourcePort
+            0x1E, // RxBufferSize
+            0x1F, // TxBufferSize
+            0x2C, // InterruptMask
+            0x2F, // KeepAliveTimer
+        };
+        return registers[slot];
+    }
+
+    static int socket_slot(const SocketRegister &reg) {
+        for (uint8_t slot = 0; slot < socket_slots; slot++) {
+            if (slot_register(slot) == reg.offset) {
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    static uint8_t socket_slot_offset(int slot) {
+        // Source port is the only two byte register
+        return slot <= 1 ? slot : slot + 1;
+    }
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_REGISTERCACHE_H_
@@ -1,10 +1,14 @@
 #ifndef _W5500__W5500_REGISTERS_H_
 #define _W5500__W5500_REGISTERS_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace W5500 {
 
+// Number of hardware sockets
+static const size_t max_sockets = 8;
+
 // Bank addresses
 constexpr uint8_t COMMON_REGISTER_BANK = 0x0;
 
@@ -68,6 +72,21 @@ static CommonRegister UnreachablePort{0x2C, 2};
 static CommonRegister PhyConfig{0x2E};
 static CommonRegister ChipVersion{0x39};
 
+// Time for an unacknowledged TCP segment to time out, in units of 100us,
+// given RetryTime and RetryCount. Each retry doubles the timeout, until
+// doubling again would overflow RetryTime.
+inline uint32_t tcp_timeout(uint16_t retry_time, uint8_t retry_count) {
+    uint32_t timeout = 0;
+    uint32_t interval = retry_time;
+    for (unsigned retry = 0; retry <= retry_count; retry++) {
+        timeout += interval;
+        if (interval * 2 <= 0xFFFF) {
+            interval *= 2;
+        }
+    }
+    return timeout;
+}
+
 enum class ModeFlags : uint8_t {
     // If set to 1, registers will be initialized.
     // Cleared to 0 after SW reset.
@@ -165,6 +184,9 @@ static SocketRegister InterruptMask{0x2C};
 static SocketRegister FragmentOffset{0x2D, 2};
 static SocketRegister KeepAliveTimer{0x2F};
 
+// Size of the contiguous socket register block (0x00 - 0x2F)
+static const uint8_t block_size = 0x30;
+
 enum class ModeFlags : uint8_t {
     // In UDP mode, 0 disables / 1 enables multicast
     // In MACRAW mode, a 0 value allows the W5500 to receive all
@@ -242,6 +264,7 @@ class InterruptRegisterValue {
     bool operator&(InterruptFlags flag) {
         return _flags & static_cast<uint8_t>(flag);
     }
+    uint8_t value() const { return _flags; }
 
   private:
     const uint8_t _flags;
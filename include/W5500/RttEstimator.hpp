@@ -0,0 +1,150 @@
+#ifndef _W5500__W5500_RTTESTIMATOR_H_
+#define _W5500__W5500_RTTESTIMATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+
+// Adapts the IC's retransmission timing to each destination's measured
+// round trip time.
+//
+// RTR and RCR are common registers, so by default a socket talking to the
+// gateway and one talking to a distant server retry on the same schedule:
+// too slowly for the first, or too eagerly for the second. The estimator
+// times each CONNECT (until CON) and each TCP SEND (until SEND_OK), keeps a
+// smoothed round trip time and variance per destination (Jacobson/Karels,
+// as in RFC 6298), and reprograms RTR and RCR just before each operation.
+// The retry count is chosen so that the total time before the socket gives
+// up stays close to a fixed budget whatever the retry time.
+//
+// The IC applies the common registers to every segment it retries, so while
+// operations on several sockets overlap, the longest of their timeouts is
+// programmed; a nearby destination never makes a distant one time out early.
+// A sample that took longer than the timeout in force must have included a
+// retransmission, so it is not used; the destination's timeout is doubled
+// instead (Karn's algorithm), as it is when an operation times out.
+//
+// Call begin() just before issuing CONNECT or SEND, and pass the socket's
+// interrupt flags to event(), either from a Reactor (see handler()) or from
+// whatever already waits on them. A Reactor clears the flags it dispatches,
+// so attach the handler for events only, leaving RECV and DISCON to the
+// socket's owner.
+//
+// This takes over RTR and RCR, so use set_give_up_time() rather than
+// KeepaliveMonitor::set_retransmission() to bound how long a dead peer takes
+// to detect; the monitor reads back whatever timeout is programmed.
+class RttEstimator {
+  public:
+    static const size_t max_destinations = 8;
+    // Flags event() needs, for Reactor::attach()
+    static const uint8_t events =
+        static_cast<uint8_t>(Registers::Socket::InterruptFlags::CONNECT) |
+        static_cast<uint8_t>(Registers::Socket::InterruptFlags::SEND_OK) |
+        static_cast<uint8_t>(Registers::Socket::InterruptFlags::TIMEOUT);
+
+    // Estimate for one socket's current destination, in milliseconds
+    struct SocketStats {
+        uint32_t srtt_ms = 0;
+        uint32_t rttvar_ms = 0;
+        uint32_t rto_ms = 0;
+        // Samples taken on this socket, and those discarded as ambiguous
+        uint32_t samples = 0;
+        uint32_t ambiguous = 0;
+        uint32_t timeouts = 0;
+    };
+
+    struct Stats {
+        uint32_t samples = 0;
+        // Writes of RTR and RCR, and begin() calls that needed none
+        uint32_t profile_writes = 0;
+        uint32_t profile_skips = 0;
+    };
+
+    explicit RttEstimator(W5500 &driver) : _driver(driver) {}
+
+    // Bounds on the retransmission timeout. The IC can't wait longer than
+    // 6553ms between retries.
+    void set_rto_limits(uint32_t min_ms, uint32_t max_ms);
+    // Total time to retry a segment before the socket times out. The
+    // default, 31.8s, is the chip's default; lower it for faster failover,
+    // as this is also how long a KeepaliveMonitor probe waits.
+    void set_give_up_time(uint32_t ms) { _give_up_ms = ms; }
+
+    // Program the retransmission profile for a socket's destination, and
+    // start timing an operation on it
+    void begin(uint8_t socket, const uint8_t ip[4]);
+    // Interrupt flags seen on a socket. CON and SEND_OK complete a sample,
+    // TIMEOUT backs off the destination's timeout.
+    void event(uint8_t socket, uint8_t flags);
+    // Reactor::Handler that feeds event(), with the estimator as ctx.
+    // Attach it with events.
+    static void handler(uint8_t socket, uint8_t flags, void *ctx) {
+        static_cast<RttEstimator *>(ctx)->event(socket, flags);
+    }
+
+    // Current timeout for a destination, in milliseconds
+    uint32_t rto_ms(const uint8_t ip[4]) const;
+
+    SocketStats socket_stats(uint8_t socket) const;
+    const Stats &stats() const { return _stats; }
+    void reset_stats();
+
+  private:
+    struct Destination {
+        uint8_t ip[4];
+        bool valid = false;
+        bool measured = false;
+        // Smoothed round trip time and mean deviation, scaled by 8 and by 4
+        // so the gains of 1/8 and 1/4 keep their fractions
+        int32_t srtt_x8 = 0;
+        int32_t rttvar_x4 = 0;
+        uint32_t rto_ms = 0;
+        // For replacing the least recently used destination
+        uint32_t last_used = 0;
+    };
+
+    struct Operation {
+        uint8_t ip[4];
+        bool pending = false;
+        uint64_t started_ms = 0;
+        // Timeout programmed when the operation was issued
+        uint32_t rto_ms = 0;
+    };
+
+    W5500 &_driver;
+    Destination _destinations[max_destinations];
+    Operation _operations[max_sockets];
+    SocketStats _socket_stats[max_sockets];
+    uint32_t _uses = 0;
+
+    uint32_t _min_rto_ms = 10;
+    uint32_t _max_rto_ms = 6553;
+    uint32_t _give_up_ms = 31800;
+    // Values last written to RTR and RCR, and the give up time the count
+    // was chosen for. RTR is 0 until the first write.
+    uint16_t _retry_time = 0;
+    uint8_t _retry_count = 0;
+    uint32_t _applied_give_up_ms = 0;
+
+    Stats _stats;
+
+    // Disallow copying
+    RttEstimator(const RttEstimator &);
+    RttEstimator &operator=(const RttEstimator &);
+
+    Destination *find(const uint8_t ip[4]);
+    const Destination *find(const uint8_t ip[4]) const;
+    Destination &lookup(const uint8_t ip[4]);
+    uint32_t clamp(uint32_t rto_ms) const;
+    void sample(Destination &destination, uint32_t rtt_ms);
+    void back_off(Destination &destination);
+    void update_socket_stats(uint8_t socket, const Destination &destination);
+    void apply(uint32_t rto_ms);
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_RTTESTIMATOR_H_
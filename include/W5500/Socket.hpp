@@ -4,7 +4,10 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include <W5500/FrameRing.hpp>
 #include <W5500/Registers.hpp>
+#include <W5500/Static/SendStream.hpp>
+#include <W5500/Static/TcpSocket.hpp>
 
 namespace W5500 {
 
@@ -13,6 +16,12 @@ class W5500;
 
 class Socket {
   public:
+    // Called with each chunk of received data by consume(). Returns how
+    // many bytes of the chunk it took; anything less than the whole chunk
+    // stops there, leaving the rest in the RX buffer.
+    typedef size_t (*ConsumeCallback)(const uint8_t *data, size_t size,
+                                      void *ctx);
+
     Socket(W5500 &driver, uint8_t sockfd) : _driver(driver), _sockfd(sockfd) {}
     virtual ~Socket() {}
 
@@ -35,8 +44,15 @@ class Socket {
     virtual int peek(uint8_t *buffer, size_t size);
     virtual int read(uint8_t *buffer, size_t size);
     virtual void flush();
+    // Stream up to max_bytes of received data to a callback, in bounded
+    // chunks, without staging it all in a buffer
+    virtual int consume(ConsumeCallback callback, void *ctx,
+                        size_t max_bytes = SIZE_MAX);
 
     int write(const uint8_t *buffer, size_t size);
+    // Combine small writes in a host buffer until send(), see
+    // W5500::set_tx_buffer
+    void set_tx_buffer(uint8_t *buffer, uint16_t size);
     int send(const uint8_t *buffer, size_t size);
     void send();
 
@@ -55,6 +71,15 @@ class Socket {
     uint16_t _write_offset = 0;
 };
 
+// One datagram returned by UdpSocket::recv_batch
+struct UdpDatagram {
+    uint8_t source_ip[4];
+    uint16_t source_port;
+    // Payload, within the buffer passed to recv_batch
+    const uint8_t *data;
+    uint16_t size;
+};
+
 class UdpSocket : public Socket {
   public:
     using Socket::Socket;
@@ -69,19 +94,31 @@ class UdpSocket : public Socket {
     uint8_t read() override;
     int read(uint8_t *buffer, size_t size) override;
     void flush() override;
+    // Consume at most the rest of the current datagram, see
+    // read_packet_header()
+    int consume(ConsumeCallback callback, void *ctx,
+                size_t max_bytes = SIZE_MAX) override;
 
     int remaining_bytes_in_packet();
     void skip_to_packet_end();
 
+    // Receive as many whole datagrams as fit in buffer, up to max_datagrams,
+    // with a single burst read and a single read pointer update. Returns the
+    // number of datagrams received, or -1 if the next datagram is too large
+    // for the buffer. Any partially read packet is skipped first.
+    int recv_batch(uint8_t *buffer, size_t buffer_size,
+                   UdpDatagram *datagrams, size_t max_datagrams);
+
   private:
     int _packet_bytes_remaining = 0;
 };
 
+// The TCP state handling is Static::TcpSocket's; this puts the Socket
+// interface around it.
 class TcpSocket : public Socket {
   public:
-    using Socket::Socket;
-
-    uint16_t _ephemeral_port = 1;
+    TcpSocket(W5500 &driver, uint8_t sockfd)
+        : Socket(driver, sockfd), _tcp(driver, sockfd) {}
 
     bool init() override;
     bool ready() override;
@@ -89,6 +126,56 @@ class TcpSocket : public Socket {
     bool connected();
 
     void connect(const uint8_t ip[4], uint16_t port);
+    // Open the socket and wait for a connection on a local port. Returns
+    // false if the socket did not enter LISTEN. See TcpServer for accepting
+    // on several sockets at once.
+    bool listen(uint16_t port);
+
+    // Streaming send of any amount of data, see Static::SendStream.
+    // Start a stream, then call poll_stream() until it returns DONE or
+    // FAILED.
+    void send_stream(const uint8_t *data, size_t size);
+    void send_stream(StreamSource source, void *ctx);
+    StreamState poll_stream();
+    void cancel_stream();
+    size_t stream_bytes_sent() const;
+
+  private:
+    Static::TcpSocket<W5500> _tcp;
+};
+
+// Raw ethernet frames, on socket 0 (the only socket that supports MACRAW).
+// Each received frame is preceded in the RX buffer by a 2 byte length that
+// includes itself.
+class MacRawSocket : public Socket {
+  public:
+    explicit MacRawSocket(W5500 &driver) : Socket(driver, 0) {}
+
+    // Mode flags to open the socket with, from Registers::Socket::ModeFlags.
+    // With none set, every frame on the wire is received.
+    void set_mode_flags(uint8_t flags) { _mode_flags = flags; }
+
+    bool init() override;
+    bool ready() override;
+
+    bool has_frame();
+    // Read the next frame, truncated to size bytes. Returns the frame's
+    // length on the wire, or -1 if there is none. If the frame's length
+    // header is corrupt, everything received is dropped.
+    int read_frame(uint8_t *buffer, size_t size);
+
+    // Time stamps for capture(). Without a clock, frames are stamped 0.
+    void set_clock(CaptureClock clock, void *ctx);
+    // Move received frames into a ring, until the IC is empty or the ring
+    // is full. Frames are read in bursts of up to a slot at a time, so many
+    // small frames cost a single SPI transaction. Returns the number of
+    // frames captured.
+    int capture(FrameRing &ring);
+
+  private:
+    uint8_t _mode_flags = 0;
+    CaptureClock _clock = nullptr;
+    void *_clock_ctx = nullptr;
 };
 
 } // namespace W5500
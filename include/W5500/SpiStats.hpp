@@ -0,0 +1,186 @@
+#ifndef _W5500__W5500_SPISTATS_H_
+#define _W5500__W5500_SPISTATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/Registers.hpp>
+
+namespace W5500 {
+
+// SPI cost of a set of driver operations
+struct SpiCounters {
+    uint32_t transactions = 0;
+    uint32_t header_bytes = 0;
+    uint32_t payload_bytes = 0;
+    // Chip select edges, two per transaction
+    uint32_t cs_toggles = 0;
+
+    void add(size_t payload) {
+        transactions++;
+        header_bytes += 3;
+        payload_bytes += payload;
+        cs_toggles += 2;
+    }
+};
+
+// Per-operation and per-socket SPI counters.
+// Only collected if the driver is compiled with W5500_SPI_STATS defined;
+// otherwise the instrumentation compiles away to nothing. The macro must be
+// defined the same way for every translation unit that includes the driver.
+//
+// Every transaction is attributed to the outermost public driver method
+// that was running when it was made, so e.g. the register accesses made
+// inside send() count against SEND rather than against the pointer and
+// command accessors that send() uses internally.
+class SpiStats {
+  public:
+    enum class Operation : uint8_t {
+        OTHER,
+        RESET,
+        GET_VERSION,
+        SET_FORCE_ARP,
+        NETWORK_CONFIG,
+        LINK_UP,
+        SET_PHY_MODE,
+        INTERRUPTS,
+        SET_SOCKET_MODE,
+        SOCKET_BUFFER_SIZE,
+        GET_SOCKET_STATUS,
+        SEND_SOCKET_COMMAND,
+        SOCKET_ADDRESS,
+        GET_TX_FREE_SIZE,
+        TX_POINTERS,
+        GET_RX_BYTE_COUNT,
+        RX_POINTERS,
+        SOCKET_INTERRUPTS,
+        SNAPSHOT,
+        REGISTER_CACHE,
+        SEND,
+        WRITE,
+        PEEK,
+        READ,
+        FLUSH,
+        PEEK_ASYNC,
+        WRITE_ASYNC,
+        CONSUME,
+        RETRANSMISSION,
+    };
+    static const size_t operation_count =
+        static_cast<size_t>(Operation::RETRANSMISSION) + 1;
+
+    static const char *operation_name(Operation op) {
+        switch (op) {
+        case Operation::OTHER:
+            return "other";
+        case Operation::RESET:
+            return "reset";
+        case Operation::GET_VERSION:
+            return "get_version";
+        case Operation::SET_FORCE_ARP:
+            return "set_force_arp";
+        case Operation::NETWORK_CONFIG:
+            return "network_config";
+        case Operation::LINK_UP:
+            return "link_up";
+        case Operation::SET_PHY_MODE:
+            return "set_phy_mode";
+        case Operation::INTERRUPTS:
+            return "interrupts";
+        case Operation::SET_SOCKET_MODE:
+            return "set_socket_mode";
+        case Operation::SOCKET_BUFFER_SIZE:
+            return "socket_buffer_size";
+        case Operation::GET_SOCKET_STATUS:
+            return "get_socket_status";
+        case Operation::SEND_SOCKET_COMMAND:
+            return "send_socket_command";
+        case Operation::SOCKET_ADDRESS:
+            return "socket_address";
+        case Operation::GET_TX_FREE_SIZE:
+            return "get_tx_free_size";
+        case Operation::TX_POINTERS:
+            return "tx_pointers";
+        case Operation::GET_RX_BYTE_COUNT:
+            return "get_rx_byte_count";
+        case Operation::RX_POINTERS:
+            return "rx_pointers";
+        case Operation::SOCKET_INTERRUPTS:
+            return "socket_interrupts";
+        case Operation::SNAPSHOT:
+            return "snapshot";
+        case Operation::REGISTER_CACHE:
+            return "register_cache";
+        case Operation::SEND:
+            return "send";
+        case Operation::WRITE:
+            return "write";
+        case Operation::PEEK:
+            return "peek";
+        case Operation::READ:
+            return "read";
+        case Operation::FLUSH:
+            return "flush";
+        case Operation::PEEK_ASYNC:
+            return "peek_async";
+        case Operation::WRITE_ASYNC:
+            return "write_async";
+        case Operation::CONSUME:
+            return "consume";
+        case Operation::RETRANSMISSION:
+            return "retransmission";
+        }
+        return "unknown";
+    }
+
+    // Totals across everything
+    SpiCounters total;
+    // By the public driver method that caused the transaction
+    SpiCounters operations[operation_count];
+    // By socket, for socket register and buffer accesses
+    SpiCounters sockets[max_sockets];
+    // Common register accesses
+    SpiCounters common;
+
+    const SpiCounters &operation(Operation op) const {
+        return operations[static_cast<size_t>(op)];
+    }
+
+    void reset() { *this = SpiStats(); }
+
+    // Count one transaction to the given register block
+    void record(uint8_t block, size_t payload) {
+        total.add(payload);
+        operations[static_cast<size_t>(_current)].add(payload);
+        if (block == COMMON_REGISTER_BANK) {
+            common.add(payload);
+        } else {
+            // Each socket has a register, TX and RX block
+            sockets[(block - 1) >> 2].add(payload);
+        }
+    }
+
+    // Attributes transactions to an operation for as long as it is in
+    // scope, unless an enclosing operation is already being counted
+    class Scope {
+      public:
+        Scope(SpiStats &stats, Operation op)
+            : _stats(stats), _previous(stats._current) {
+            if (_previous == Operation::OTHER) {
+                _stats._current = op;
+            }
+        }
+        ~Scope() { _stats._current = _previous; }
+
+      private:
+        SpiStats &_stats;
+        const Operation _previous;
+    };
+
+  private:
+    Operation _current = Operation::OTHER;
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_SPISTATS_H_
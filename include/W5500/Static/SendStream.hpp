@@ -0,0 +1,186 @@
+#ifndef _W5500__W5500_STATIC_SENDSTREAM_H_
+#define _W5500__W5500_STATIC_SENDSTREAM_H_
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <W5500/Registers.hpp>
+
+namespace W5500 {
+
+enum class StreamState : uint8_t {
+    // No stream started
+    IDLE,
+    // Data still to write or send
+    SENDING,
+    // Everything has been sent
+    DONE,
+    // The connection timed out or closed
+    FAILED,
+};
+
+// Data source for a send stream. Fill up to size bytes of buffer and return
+// how many were written; returning 0 ends the stream.
+typedef size_t (*StreamSource)(uint8_t *buffer, size_t size, void *ctx);
+
+namespace Static {
+
+// Non-blocking streaming send for a TCP socket, of any length of data.
+// Each call to poll() tops the socket's TX buffer up with as much data as
+// there is room for, and issues SEND once a batch of data is waiting and
+// the previous SEND has completed. Data for the next batch is written while
+// the current one is still on the wire, so that it can go out as soon as
+// SEND_OK is seen.
+//
+// The stream owns the socket's SEND_OK flag while it runs. poll() can be
+// called from a main loop, or when the socket's interrupt fires.
+template <typename DriverT> class SendStream {
+  public:
+    // Bytes to collect before issuing SEND, unless the data runs out first
+    static const uint16_t default_batch = 1460;
+
+    SendStream() {}
+
+    // Stream from memory. The data must stay valid until the stream ends.
+    void start(const uint8_t *data, size_t size) {
+        restart();
+        _data = data;
+        _remaining = size;
+        _source_done = size == 0;
+    }
+
+    // Stream from a callback
+    void start(StreamSource source, void *ctx) {
+        restart();
+        _source = source;
+        _source_ctx = ctx;
+    }
+
+    // Stop without sending anything more. Data already written to the IC
+    // but not yet sent is left there.
+    void cancel() { _state = StreamState::IDLE; }
+
+    void set_batch(uint16_t bytes) { _batch = bytes > 0 ? bytes : 1; }
+
+    StreamState state() const { return _state; }
+    // Bytes copied to the IC, and bytes the IC has finished sending
+    size_t bytes_written() const { return _bytes_written; }
+    size_t bytes_sent() const { return _bytes_sent; }
+
+    StreamState poll(DriverT &driver, uint8_t socket) {
+        if (_state != StreamState::SENDING) {
+            return _state;
+        }
+
+        // Check on the SEND in flight, if any
+        Registers::Socket::InterruptRegisterValue flags =
+            driver.get_socket_interrupt_flags(socket);
+        if (flags & Registers::Socket::InterruptFlags::SEND_OK) {
+            // A SEND_OK left over from before the stream started is cleared
+            // too, so it can't be mistaken for one of ours
+            driver.clear_socket_interrupt_flag(
+                socket, Registers::Socket::InterruptFlags::SEND_OK);
+            if (_in_flight > 0) {
+                _bytes_sent += _in_flight;
+                _in_flight = 0;
+            }
+        }
+        if ((flags & Registers::Socket::InterruptFlags::TIMEOUT) ||
+            ((flags & Registers::Socket::InterruptFlags::DISCONNECT) &&
+             driver.get_socket_status(socket) ==
+                 Registers::Socket::StatusValue::CLOSED)) {
+            _state = StreamState::FAILED;
+            return _state;
+        }
+
+        const bool buffer_full = refill(driver, socket);
+
+        // Start the next batch. Small batches go out when nothing more can
+        // be added to them.
+        if (_in_flight == 0 && _unsent > 0 &&
+            (_unsent >= _batch || _source_done || buffer_full)) {
+            driver.send(socket);
+            _in_flight = _unsent;
+            _unsent = 0;
+        }
+
+        if (_source_done && _unsent == 0 && _in_flight == 0) {
+            _state = StreamState::DONE;
+        }
+        return _state;
+    }
+
+  private:
+    static const size_t source_chunk_size = 256;
+
+    StreamState _state = StreamState::IDLE;
+    uint16_t _batch = default_batch;
+
+    // Memory source
+    const uint8_t *_data = nullptr;
+    size_t _remaining = 0;
+    // Callback source
+    StreamSource _source = nullptr;
+    void *_source_ctx = nullptr;
+    bool _source_done = false;
+
+    // Bytes written to the IC but not sent, and bytes in the SEND in flight
+    size_t _unsent = 0;
+    size_t _in_flight = 0;
+
+    size_t _bytes_written = 0;
+    size_t _bytes_sent = 0;
+
+    void restart() {
+        _state = StreamState::SENDING;
+        _data = nullptr;
+        _remaining = 0;
+        _source = nullptr;
+        _source_ctx = nullptr;
+        _source_done = false;
+        _unsent = 0;
+        _in_flight = 0;
+        _bytes_written = 0;
+        _bytes_sent = 0;
+    }
+
+    // Write as much as fits in the TX buffer. Returns true if it is full.
+    bool refill(DriverT &driver, uint8_t socket) {
+        if (_source_done) {
+            return false;
+        }
+        size_t free = driver.get_tx_free_size(socket);
+        while (free > 0 && !_source_done) {
+            size_t written;
+            if (_source == nullptr) {
+                written = driver.write(socket, _data, 0,
+                                       _remaining < free ? _remaining : free);
+                _data += written;
+                _remaining -= written;
+                _source_done = _remaining == 0;
+            } else {
+                // Only ask for what is known to fit, so nothing is left over
+                uint8_t chunk[source_chunk_size];
+                const size_t size = free < sizeof(chunk) ? free : sizeof(chunk);
+                const size_t produced = _source(chunk, size, _source_ctx);
+                if (produced == 0) {
+                    _source_done = true;
+                    break;
+                }
+                written = driver.write(socket, chunk, 0, produced);
+            }
+            if (written == 0) {
+                break;
+            }
+            _unsent += written;
+            _bytes_written += written;
+            free -= written;
+        }
+        return free == 0;
+    }
+};
+
+} // namespace Static
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_STATIC_SENDSTREAM_H_
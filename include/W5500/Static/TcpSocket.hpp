@@ -0,0 +1,146 @@
+#ifndef _W5500__W5500_STATIC_TCPSOCKET_H_
+#define _W5500__W5500_STATIC_TCPSOCKET_H_
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <W5500/Registers.hpp>
+#include <W5500/Static/SendStream.hpp>
+
+namespace W5500 {
+namespace Static {
+
+// TCP socket, parameterized on the driver type.
+// Without any virtual methods, so that paired with a Static::W5500<BusT> the
+// whole path from socket call to bus access can be inlined. ::W5500::TcpSocket
+// is this, instantiated on ::W5500::W5500.
+template <typename DriverT> class TcpSocket {
+  public:
+    TcpSocket(DriverT &driver, uint8_t sockfd)
+        : _driver(driver), _sockfd(sockfd) {}
+
+    bool init() {
+        _driver.set_socket_mode(_sockfd, SocketMode::TCP);
+        _driver.send_socket_command(_sockfd,
+                                    Registers::Socket::CommandValue::OPEN);
+        return ready();
+    }
+
+    bool ready() {
+        const Registers::Socket::StatusValue status =
+            _driver.get_socket_status(_sockfd);
+        // Return true if the socket is open, connecting or connected.
+        return status == Registers::Socket::StatusValue::INIT ||
+               status == Registers::Socket::StatusValue::LISTEN ||
+               status == Registers::Socket::StatusValue::SYN_SENT ||
+               status == Registers::Socket::StatusValue::SYN_RECV ||
+               status == Registers::Socket::StatusValue::ESTABLISHED;
+    }
+
+    bool connecting() {
+        return _driver.get_socket_status(_sockfd) ==
+               Registers::Socket::StatusValue::SYN_SENT;
+    }
+
+    bool connected() {
+        return _driver.get_socket_status(_sockfd) ==
+               Registers::Socket::StatusValue::ESTABLISHED;
+    }
+
+    void connect(const uint8_t ip[4], uint16_t port) {
+        _driver.set_socket_dest_ip_address(_sockfd, ip);
+        _driver.set_socket_dest_port(_sockfd, port);
+        _driver.set_socket_src_port(_sockfd, _ephemeral_port++);
+        _driver.send_socket_command(_sockfd,
+                                    Registers::Socket::CommandValue::CONNECT);
+    }
+
+    bool listen(uint16_t port) {
+        _driver.set_socket_src_port(_sockfd, port);
+        init();
+        _driver.send_socket_command(_sockfd,
+                                    Registers::Socket::CommandValue::LISTEN);
+        return _driver.get_socket_status(_sockfd) ==
+               Registers::Socket::StatusValue::LISTEN;
+    }
+
+    void close() {
+        _driver.send_socket_command(_sockfd,
+                                    Registers::Socket::CommandValue::CLOSE);
+    }
+
+    bool phy_link_up() { return _driver.link_up(); }
+
+    Registers::Socket::InterruptRegisterValue get_interrupt_flags() {
+        return _driver.get_socket_interrupt_flags(_sockfd);
+    }
+
+    void clear_interrupt_flag(Registers::Socket::InterruptFlags val) {
+        _driver.clear_socket_interrupt_flag(_sockfd, val);
+    }
+
+    uint16_t rx_byte_count() { return _driver.get_rx_byte_count(_sockfd); }
+
+    uint8_t read() { return _driver.read(_sockfd); }
+
+    int peek(uint8_t *buffer, size_t size) {
+        return _driver.peek(_sockfd, buffer, size);
+    }
+
+    int read(uint8_t *buffer, size_t size) {
+        return _driver.read(_sockfd, buffer, size);
+    }
+
+    void flush() { _driver.flush(_sockfd); }
+
+    int write(const uint8_t *buffer, size_t size) {
+        const int ret = _driver.write(_sockfd, buffer, _write_offset, size);
+        _write_offset += ret;
+        return ret;
+    }
+
+    int send(const uint8_t *buffer, size_t size) {
+        const int ret = _driver.send(_sockfd, buffer, _write_offset, size);
+        _write_offset = 0;
+        return ret;
+    }
+
+    void send() {
+        if (_write_offset == 0) {
+            return;
+        }
+        _driver.send(_sockfd);
+        _write_offset = 0;
+    }
+
+    // Streaming send of any amount of data, see SendStream
+    void send_stream(const uint8_t *data, size_t size) {
+        _stream.start(data, size);
+    }
+    void send_stream(StreamSource source, void *ctx) {
+        _stream.start(source, ctx);
+    }
+    StreamState poll_stream() { return _stream.poll(_driver, _sockfd); }
+    void cancel_stream() { _stream.cancel(); }
+    size_t stream_bytes_sent() const { return _stream.bytes_sent(); }
+
+  private:
+    DriverT &_driver;
+    const uint8_t _sockfd;
+
+    // Offset for tracking writes without matching send
+    uint16_t _write_offset = 0;
+
+    uint16_t _ephemeral_port = 1;
+
+    SendStream<DriverT> _stream;
+
+    // Disallow copying of sockets
+    TcpSocket(const TcpSocket &);
+    TcpSocket &operator=(const TcpSocket &);
+};
+
+} // namespace Static
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_STATIC_TCPSOCKET_H_
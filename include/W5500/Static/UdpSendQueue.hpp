@@ -0,0 +1,189 @@
+#ifndef _W5500__W5500_STATIC_UDPSENDQUEUE_H_
+#define _W5500__W5500_STATIC_UDPSENDQUEUE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <W5500/Registers.hpp>
+
+namespace W5500 {
+namespace Static {
+
+// Queue of outgoing datagrams for a UDP socket, each with its own
+// destination. Works with either ::W5500::W5500 or a Static::W5500.
+//
+// The IC only handles one SEND per socket at a time, and the destination
+// registers must not change until it finishes, so datagrams are sent one
+// by one: poll() checks the socket's SEND_OK and TIMEOUT flags, completes
+// the datagram in flight, and immediately starts the next, writing its
+// destination (if different from the last one), payload and SEND. A
+// TIMEOUT means ARP for the destination failed.
+//
+// Entries live in caller-provided storage, and payloads are not copied, so
+// they must stay valid until the datagram completes. The queue owns the
+// socket's SEND_OK and TIMEOUT flags while it has datagrams in flight.
+template <typename DriverT> class UdpSendQueue {
+  public:
+    enum class Status : uint8_t {
+        QUEUED,
+        SENDING,
+        SENT,
+        // Destination could not be resolved
+        TIMEOUT,
+    };
+
+    struct Entry {
+        uint8_t dest_ip[4];
+        uint16_t dest_port;
+        const uint8_t *data;
+        uint16_t size;
+        Status status;
+        // For the caller's use
+        void *tag;
+    };
+
+    // Called as each datagram completes
+    typedef void (*Callback)(const Entry &entry, void *ctx);
+
+    struct Stats {
+        uint32_t sent = 0;
+        uint32_t timeouts = 0;
+        // Destination register writes skipped as unchanged
+        uint32_t dest_reuses = 0;
+    };
+
+    UdpSendQueue(DriverT &driver, uint8_t socket, Entry *storage,
+                 size_t capacity)
+        : _driver(driver), _socket(socket), _entries(storage),
+          _capacity(capacity) {}
+
+    void set_callback(Callback callback, void *ctx) {
+        _callback = callback;
+        _callback_ctx = ctx;
+    }
+
+    // Queue a datagram. Returns false if the queue is full.
+    bool push(const uint8_t dest_ip[4], uint16_t dest_port,
+              const uint8_t *data, uint16_t size, void *tag = nullptr) {
+        if (_count == _capacity) {
+            return false;
+        }
+        Entry &entry = _entries[(_head + _count) % _capacity];
+        memcpy(entry.dest_ip, dest_ip, 4);
+        entry.dest_port = dest_port;
+        entry.data = data;
+        entry.size = size;
+        entry.status = Status::QUEUED;
+        entry.tag = tag;
+        _count++;
+        return true;
+    }
+
+    // Datagrams queued or in flight
+    size_t pending() const { return _count; }
+    bool empty() const { return _count == 0; }
+    bool full() const { return _count == _capacity; }
+
+    // Complete the datagram in flight if the IC is done with it, and start
+    // the next one
+    void poll() {
+        if (_in_flight) {
+            Registers::Socket::InterruptRegisterValue flags =
+                _driver.get_socket_interrupt_flags(_socket);
+            if (flags & Registers::Socket::InterruptFlags::SEND_OK) {
+                _driver.clear_socket_interrupt_flag(
+                    _socket, Registers::Socket::InterruptFlags::SEND_OK);
+                _stats.sent++;
+                complete(Status::SENT);
+            } else if (flags & Registers::Socket::InterruptFlags::TIMEOUT) {
+                _driver.clear_socket_interrupt_flag(
+                    _socket, Registers::Socket::InterruptFlags::TIMEOUT);
+                _stats.timeouts++;
+                // The IC no longer knows a MAC for the destination
+                _dest_valid = false;
+                complete(Status::TIMEOUT);
+            } else {
+                return;
+            }
+        } else if (_count > 0) {
+            // Don't mistake a flag from earlier for this datagram's
+            _driver.clear_socket_interrupt_flag(
+                _socket, Registers::Socket::InterruptFlags::SEND_OK);
+            _driver.clear_socket_interrupt_flag(
+                _socket, Registers::Socket::InterruptFlags::TIMEOUT);
+        }
+
+        if (_count > 0) {
+            start(_entries[_head]);
+        }
+    }
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    DriverT &_driver;
+    const uint8_t _socket;
+
+    // Ring of entries
+    Entry *const _entries;
+    const size_t _capacity;
+    size_t _head = 0;
+    size_t _count = 0;
+
+    bool _in_flight = false;
+
+    // Destination currently in the socket's registers
+    uint8_t _dest_ip[4];
+    uint16_t _dest_port = 0;
+    bool _dest_valid = false;
+
+    Callback _callback = nullptr;
+    void *_callback_ctx = nullptr;
+    Stats _stats;
+
+    // Disallow copying
+    UdpSendQueue(const UdpSendQueue &);
+    UdpSendQueue &operator=(const UdpSendQueue &);
+
+    void start(Entry &entry) {
+        // A datagram has to go to the IC whole, so wait for room
+        if (_driver.get_tx_free_size(_socket) < entry.size) {
+            return;
+        }
+
+        if (_dest_valid && memcmp(_dest_ip, entry.dest_ip, 4) == 0 &&
+            _dest_port == entry.dest_port) {
+            _stats.dest_reuses++;
+        } else {
+            _driver.set_socket_dest_ip_address(_socket, entry.dest_ip);
+            _driver.set_socket_dest_port(_socket, entry.dest_port);
+            memcpy(_dest_ip, entry.dest_ip, 4);
+            _dest_port = entry.dest_port;
+            _dest_valid = true;
+        }
+
+        _driver.send(_socket, entry.data, 0, entry.size);
+        entry.status = Status::SENDING;
+        _in_flight = true;
+    }
+
+    void complete(Status status) {
+        Entry &entry = _entries[_head];
+        entry.status = status;
+        _head = (_head + 1) % _capacity;
+        _count--;
+        _in_flight = false;
+        if (_callback != nullptr) {
+            // The callback may queue another datagram into the same slot
+            const Entry done = entry;
+            _callback(done, _callback_ctx);
+        }
+    }
+};
+
+} // namespace Static
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_STATIC_UDPSENDQUEUE_H_
@@ -0,0 +1,1284 @@
+#ifndef _W5500__W5500_STATIC_W5500_H_
+#define _W5500__W5500_STATIC_W5500_H_
+
+#include <string.h>
+#include <unistd.h>
+
+#include <initializer_list>
+
+#include <W5500/Bus.hpp>
+#include <W5500/RegisterCache.hpp>
+#include <W5500/Registers.hpp>
+#include <W5500/SpiStats.hpp>
+
+// Attribute SPI traffic within a driver method to an operation
+#ifdef W5500_SPI_STATS
+#define W5500_SPI_OPERATION(op)                                                \
+    SpiStats::Scope _spi_scope(_spi_stats, SpiStats::Operation::op)
+#else
+#define W5500_SPI_OPERATION(op)
+#endif
+
+namespace W5500 {
+
+// Decoded copy of a socket's register block, read in a single burst
+struct SocketSnapshot {
+    uint8_t mode;
+    Registers::Socket::StatusValue status;
+    uint8_t interrupt_flags;
+    uint8_t interrupt_mask;
+    uint16_t source_port;
+    uint8_t dest_mac[6];
+    uint8_t dest_ip[4];
+    uint16_t dest_port;
+    uint16_t max_segment_size;
+    Registers::Socket::BufferSize rx_buffer_size;
+    Registers::Socket::BufferSize tx_buffer_size;
+    uint16_t tx_free_size;
+    uint16_t tx_read_pointer;
+    uint16_t tx_write_pointer;
+    uint16_t rx_byte_count;
+    uint16_t rx_read_pointer;
+    uint16_t rx_write_pointer;
+    uint8_t keepalive_timer;
+
+    Registers::Socket::InterruptRegisterValue interrupts() const {
+        return Registers::Socket::InterruptRegisterValue(interrupt_flags);
+    }
+};
+
+// Counters for socket snapshots, comparing the SPI traffic used against the
+// same state read out one register at a time.
+struct SnapshotCounters {
+    uint32_t snapshots = 0;
+    uint32_t spi_transactions = 0;
+    uint32_t spi_bytes = 0;
+    uint32_t individual_transactions = 0;
+    uint32_t individual_bytes = 0;
+};
+
+namespace Static {
+
+// Driver for the W5500, parameterized on the bus type.
+// When BusT is a concrete bus class marked final, all bus calls are
+// statically dispatched and the register accessors can be inlined into their
+// callers. The runtime polymorphic ::W5500::W5500 is this template
+// instantiated over the Bus interface.
+template <typename BusT> class W5500 {
+  public:
+    W5500(BusT &bus) : _bus(bus) {}
+    void init();
+
+    void reset();
+    uint8_t get_version();
+
+    void set_force_arp(bool enable);
+
+    void set_mac(uint8_t mac[6]);
+    void get_mac(uint8_t mac[6]);
+    void set_gateway(uint8_t gwip[4]);
+    void get_gateway(uint8_t gwip[4]);
+    void set_subnet_mask(uint8_t mask[4]);
+    void get_subnet_mask(uint8_t mask[4]);
+    void set_ip(uint8_t ip[4]);
+    void get_ip(uint8_t ip[4]);
+
+    // PHY status
+    bool link_up();
+    void set_phy_mode(Registers::Common::PhyOperationMode mode);
+
+    // TCP retransmission, for every socket. The retry time is in units of
+    // 100us; a TCP segment is retried retry count times, with the timeout
+    // doubling each time, before the socket times out.
+    void set_retry_time(uint16_t time);
+    uint16_t get_retry_time();
+    void set_retry_count(uint8_t count);
+    uint8_t get_retry_count();
+
+    // General interrupts
+    void set_interrupt_mask(
+        std::initializer_list<Registers::Common::InterruptMaskFlags> flags);
+    Registers::Common::InterruptRegisterValue get_interrupt_state();
+    bool has_interrupt_flag(Registers::Common::InterruptFlags flag);
+    void clear_interrupt_flag(Registers::Common::InterruptFlags flag);
+
+    // Socket connection handling
+    void set_socket_mode(uint8_t socket, SocketMode mode);
+    void set_socket_buffer_size(uint8_t socket,
+                                Registers::Socket::BufferSize size);
+    Registers::Socket::BufferSize get_socket_tx_buffer_size(uint8_t socket);
+    Registers::Socket::BufferSize get_socket_rx_buffer_size(uint8_t socket);
+    void set_socket_tx_buffer_size(uint8_t socket,
+                                   Registers::Socket::BufferSize size);
+    void set_socket_rx_buffer_size(uint8_t socket,
+                                   Registers::Socket::BufferSize size);
+    Registers::Socket::StatusValue get_socket_status(uint8_t socket);
+    void send_socket_command(uint8_t socket,
+                             Registers::Socket::CommandValue command);
+    void set_socket_dest_ip_address(uint8_t socket, const uint8_t target_ip[4]);
+    void set_socket_dest_mac(uint8_t socket, const uint8_t mac[6]);
+    void get_socket_dest_mac(uint8_t socket, uint8_t mac[6]);
+    void set_socket_dest_port(uint8_t socket, uint16_t port);
+    void set_socket_src_port(uint8_t socket, uint16_t port);
+
+    // Socket TX/RX handling
+    uint16_t get_tx_free_size(uint8_t socket);
+    uint16_t get_tx_read_pointer(uint8_t socket);
+    uint16_t get_tx_write_pointer(uint8_t socket);
+    void set_tx_write_pointer(uint8_t socket, uint16_t offset);
+    uint16_t get_rx_byte_count(uint8_t socket);
+    uint16_t get_rx_read_pointer(uint8_t socket);
+    void set_rx_read_pointer(uint8_t socket, uint16_t offset);
+    uint16_t get_rx_write_pointer(uint8_t socket);
+
+    // TCP keepalive. With a non-zero interval (in units of 5s) the IC sends
+    // keepalives on its own; otherwise they can be sent with send_keepalive()
+    // once at least one byte has been exchanged.
+    void set_socket_keepalive_interval(uint8_t socket, uint8_t interval);
+    uint8_t get_socket_keepalive_interval(uint8_t socket);
+    void send_keepalive(uint8_t socket);
+
+    // Socket interrupts
+    Registers::Socket::InterruptRegisterValue
+    get_socket_interrupt_flags(uint8_t socket);
+    bool socket_has_interrupt_flag(uint8_t socket,
+                                   Registers::Socket::InterruptFlags flag);
+    void clear_socket_interrupt_flag(uint8_t socket,
+                                     Registers::Socket::InterruptFlags flag);
+    // Clear several flags with one write
+    void clear_socket_interrupt_flags(uint8_t socket, uint8_t flags);
+    // Which of a socket's flags are reported in the socket interrupt
+    // register (Sn_IMR)
+    void set_socket_interrupt_mask(
+        uint8_t socket,
+        std::initializer_list<Registers::Socket::InterruptMaskFlags> flags);
+    void set_socket_interrupt_mask(uint8_t socket, uint8_t mask);
+    // Sockets allowed to assert INTn (SIMR), one bit per socket
+    void set_socket_interrupt_enable(uint8_t sockets);
+    uint8_t get_socket_interrupt_enable();
+    // Sockets with a reported flag set (SIR), one bit per socket. One read
+    // covers every socket.
+    uint8_t get_pending_socket_interrupts();
+    // True once if Bus::trigger_interrupt() has been called since the last
+    // time
+    bool take_interrupt();
+
+    // Socket state snapshots.
+    // Read the entire socket register block in one burst, rather than one
+    // transaction per register.
+    SocketSnapshot snapshot_socket(uint8_t socket);
+    void snapshot_all_sockets(SocketSnapshot snapshots[max_sockets]);
+    const SnapshotCounters &snapshot_counters() { return _snapshot_counters; }
+    void reset_snapshot_counters() { _snapshot_counters = SnapshotCounters(); }
+
+    // Shadow register cache.
+    // When enabled, configuration registers that only the host can modify
+    // are written through to the IC and then served from RAM. See
+    // RegisterCache for which registers are cached. The cache is dropped on
+    // reset(); call invalidate_register_cache() if the IC may have been
+    // reset or written behind the driver's back.
+    void enable_register_cache(bool enable);
+    void invalidate_register_cache() { _register_cache.invalidate(); }
+    // Refill the cache with one burst read per register block
+    void resync_register_cache();
+
+    //// Sending data
+    // Trigger a flush of data written to buffer
+    void send(uint8_t socket);
+    // Write data to buffer and immediately trigger send
+    size_t send(uint8_t socket, const uint8_t *buffer, size_t offset,
+                size_t size);
+    // Write data to buffer but do NOT automatically trigger send.
+    // Offset is the number of bytes written since the last send, which the
+    // TX write pointer already accounts for.
+    size_t write(uint8_t socket, const uint8_t *buffer, size_t offset,
+                 size_t size);
+
+    // TX write combining.
+    // The TX write pointer of each socket is tracked in host memory, so
+    // writes don't need to fetch it from the IC. Given a buffer, small
+    // writes to a socket are also staged there and copied to the IC in one
+    // burst, along with a single pointer update, when the socket sends or
+    // the buffer fills up. Writes as large as the buffer bypass it. The
+    // buffer must stay valid until it is removed again with a null pointer.
+    void set_tx_buffer(uint8_t socket, uint8_t *buffer, uint16_t size);
+    // Copy any staged data to the IC, without sending it
+    void commit_tx(uint8_t socket);
+
+    //// Receiving data
+    // Read data from the RX buffer, but do not advance read pointer
+    size_t peek(uint8_t socket, uint8_t *buffer, size_t size);
+    // Read data from the RX buffer, and advance read pointer
+    uint8_t read(uint8_t socket);
+    size_t read(uint8_t socket, uint8_t *buffer, size_t size);
+    // Clear all pending data on a socket
+    size_t flush(uint8_t socket);
+
+    // Deferred RX release.
+    // The RX read pointer of each socket is tracked in host memory, so reads
+    // don't need to fetch it from the IC. By default every read still writes
+    // the pointer back and issues RECV. With a non-zero threshold, that is
+    // deferred until at least that many bytes have been read, the socket has
+    // been drained (as seen by get_rx_byte_count()), or commit_rx() is
+    // called. Until then the IC can't reuse the space, so the threshold
+    // should be well below the socket's RX buffer size.
+    void set_rx_commit_threshold(uint16_t bytes);
+    // Write back the read pointer and issue RECV, if any reads are pending
+    void commit_rx(uint8_t socket);
+
+    //// Streaming receive
+    // Called with each chunk of received data. Returns how many bytes of
+    // the chunk it took; anything less stops there.
+    typedef size_t (*ConsumeCallback)(const uint8_t *data, size_t size,
+                                      void *ctx);
+    static const size_t consume_chunk_size = 128;
+    // Pass up to max_bytes of received data to the callback, in chunks of
+    // at most consume_chunk_size, without the caller needing a buffer for
+    // all of it. The read pointer is advanced once, after the last chunk,
+    // past only the bytes the callback took. Returns that count.
+    // Each chunk is its own SPI transaction, so the callback may use the
+    // driver, except to receive on the same socket.
+    size_t consume(uint8_t socket, ConsumeCallback callback, void *ctx,
+                   size_t max_bytes);
+
+    //// Asynchronous data transfer
+    // Start reading data from the RX buffer, but do not advance the read
+    // pointer. Once the transaction completes, use read() with a null buffer
+    // to release the data back to the IC.
+    size_t peek_async(uint8_t socket, uint8_t *buffer, size_t size,
+                      Transaction &txn);
+    // Start writing data to the TX buffer. The TX write pointer is updated
+    // before the data is queued; since the bus completes any outstanding
+    // transactions before the next synchronous access, a following send()
+    // will always be ordered after the data transfer.
+    size_t write_async(uint8_t socket, const uint8_t *buffer, size_t offset,
+                       size_t size, Transaction &txn);
+
+#ifdef W5500_SPI_STATS
+    // SPI cost counters, see SpiStats
+    const SpiStats &spi_stats() const { return _spi_stats; }
+    void reset_spi_stats() { _spi_stats.reset(); }
+#endif
+
+    BusT &bus() { return _bus; }
+
+  private:
+    BusT &_bus;
+
+#ifdef W5500_SPI_STATS
+    SpiStats _spi_stats;
+#endif
+    void count_transaction(__attribute__((unused)) uint8_t block,
+                           __attribute__((unused)) size_t size) {
+#ifdef W5500_SPI_STATS
+        _spi_stats.record(block, size);
+#endif
+    }
+
+    SnapshotCounters _snapshot_counters;
+
+    RegisterCache _register_cache;
+    bool _register_cache_enabled = false;
+
+    // Host copy of each socket's RX read pointer, and the bytes read past
+    // the value last written to the IC
+    struct RxState {
+        uint16_t read_pointer = 0;
+        uint16_t pending = 0;
+        bool valid = false;
+    };
+    RxState _rx[max_sockets];
+    uint16_t _rx_commit_threshold = 0;
+
+    void advance_rx(uint8_t socket, size_t size);
+    void invalidate_rx();
+
+    // Host copy of each socket's TX write pointer, and the write combining
+    // buffer
+    struct TxState {
+        uint16_t write_pointer = 0;
+        bool valid = false;
+        uint8_t *buffer = nullptr;
+        uint16_t capacity = 0;
+        uint16_t used = 0;
+        // Space known to be free on the IC, less what has been staged
+        uint16_t budget = 0;
+    };
+    TxState _tx[max_sockets];
+
+    size_t write_direct(uint8_t socket, const uint8_t *buffer, size_t size);
+    void reset_tx(uint8_t socket);
+
+    void write_register(CommonRegister reg, const uint8_t *data);
+    void write_register(SocketRegister reg, uint8_t socket_n,
+                        const uint8_t *data);
+    void write_register_u8(CommonRegister reg, uint8_t value);
+    void write_register_u8(SocketRegister reg, uint8_t socket, uint8_t value);
+    void write_register_u16(CommonRegister reg, uint16_t value);
+    void write_register_u16(SocketRegister reg, uint8_t socket, uint16_t value);
+
+    void read_register(CommonRegister reg, uint8_t *data);
+    void read_register(SocketRegister reg, uint8_t socket_n, uint8_t *data);
+    uint16_t read_register_u8(CommonRegister reg);
+    uint16_t read_register_u8(SocketRegister reg, uint8_t socket);
+    uint16_t read_register_u16(CommonRegister reg);
+    uint16_t read_register_u16(SocketRegister reg, uint8_t socket);
+
+    // Build the command header for an access to a block of the IC
+    static void build_header(uint8_t header[3], uint8_t block,
+                             uint16_t address, bool write);
+    // Access a block of the IC, in a single chip select
+    void access(uint8_t block, uint16_t address, bool write,
+                const uint8_t *send, uint8_t *recv, size_t size);
+};
+
+template <typename BusT> void W5500<BusT>::init() { _bus.init(); }
+
+template <typename BusT> void W5500<BusT>::set_mac(uint8_t mac[6]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    write_register(Registers::Common::SourceHardwareAddress, mac);
+}
+
+template <typename BusT> void W5500<BusT>::set_gateway(uint8_t ip[4]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    write_register(Registers::Common::GatewayAddress, ip);
+}
+
+template <typename BusT> void W5500<BusT>::set_subnet_mask(uint8_t mask[4]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    write_register(Registers::Common::SubnetMaskAddress, mask);
+}
+
+template <typename BusT> void W5500<BusT>::set_ip(uint8_t ip[4]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    write_register(Registers::Common::SourceIpAddress, ip);
+}
+
+template <typename BusT> void W5500<BusT>::get_mac(uint8_t mac[6]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    read_register(Registers::Common::SourceHardwareAddress, mac);
+}
+
+template <typename BusT> void W5500<BusT>::get_gateway(uint8_t ip[4]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    read_register(Registers::Common::GatewayAddress, ip);
+}
+
+template <typename BusT> void W5500<BusT>::get_subnet_mask(uint8_t mask[4]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    read_register(Registers::Common::SubnetMaskAddress, mask);
+}
+
+template <typename BusT> void W5500<BusT>::get_ip(uint8_t ip[4]) {
+    W5500_SPI_OPERATION(NETWORK_CONFIG);
+    read_register(Registers::Common::SourceIpAddress, ip);
+}
+
+template <typename BusT> bool W5500<BusT>::link_up() {
+    W5500_SPI_OPERATION(LINK_UP);
+    uint8_t val;
+    read_register(Registers::Common::PhyConfig, &val);
+    return val &
+           static_cast<uint8_t>(Registers::Common::PhyConfigFlags::LINK_STATUS);
+}
+
+template <typename BusT>
+Registers::Socket::StatusValue W5500<BusT>::get_socket_status(uint8_t socket) {
+    W5500_SPI_OPERATION(GET_SOCKET_STATUS);
+    return Registers::Socket::StatusValue(
+        read_register_u8(Registers::Socket::Status, socket));
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_mode(uint8_t socket, SocketMode mode) {
+    W5500_SPI_OPERATION(SET_SOCKET_MODE);
+    write_register_u8(Registers::Socket::Mode, socket,
+                      static_cast<uint8_t>(mode));
+}
+
+template <typename BusT>
+void W5500<BusT>::send_socket_command(uint8_t socket,
+                                      Registers::Socket::CommandValue command) {
+    W5500_SPI_OPERATION(SEND_SOCKET_COMMAND);
+    // Staged data has to reach the IC before it is sent
+    if (command == Registers::Socket::CommandValue::SEND ||
+        command == Registers::Socket::CommandValue::SEND_MAC) {
+        commit_tx(socket);
+    }
+
+    write_register_u8(Registers::Socket::Command, socket,
+                      static_cast<uint8_t>(command));
+
+    // Opening or closing a socket resets its buffer pointers
+    if (command == Registers::Socket::CommandValue::OPEN ||
+        command == Registers::Socket::CommandValue::CLOSE) {
+        _rx[socket] = RxState();
+        reset_tx(socket);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_dest_ip_address(uint8_t socket,
+                                             const uint8_t target_ip[4]) {
+    W5500_SPI_OPERATION(SOCKET_ADDRESS);
+    write_register(Registers::Socket::DestIPAddress, socket, target_ip);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_dest_port(uint8_t socket, uint16_t port) {
+    W5500_SPI_OPERATION(SOCKET_ADDRESS);
+    write_register_u16(Registers::Socket::DestPort, socket, port);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_src_port(uint8_t socket, uint16_t port) {
+    W5500_SPI_OPERATION(SOCKET_ADDRESS);
+    write_register_u16(Registers::Socket::SourcePort, socket, port);
+}
+
+template <typename BusT> void W5500<BusT>::reset() {
+    W5500_SPI_OPERATION(RESET);
+    // Set soft reset bit
+    uint8_t flag = static_cast<uint8_t>(Registers::Common::ModeFlags::RESET);
+    write_register(Registers::Common::Mode, &flag);
+
+    // Wait for core reset to complete
+    do {
+        read_register(Registers::Common::Mode, &flag);
+    } while (flag & static_cast<uint8_t>(Registers::Common::ModeFlags::RESET));
+
+    // Wait for PHY reset to complete
+    do {
+        read_register(Registers::Common::PhyConfig, &flag);
+    } while (!(flag &
+               static_cast<uint8_t>(Registers::Common::PhyConfigFlags::RESET)));
+
+    // Everything is back to its reset value
+    _register_cache.invalidate();
+    invalidate_rx();
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        reset_tx(socket);
+    }
+}
+
+template <typename BusT> void W5500<BusT>::set_force_arp(bool enable) {
+    W5500_SPI_OPERATION(SET_FORCE_ARP);
+    // Get current reg value
+    uint8_t flag = read_register_u8(Registers::Common::Mode);
+
+    // Set/clear FARP bit
+    if (enable) {
+        flag |= static_cast<uint8_t>(Registers::Common::ModeFlags::FORCE_ARP);
+    } else {
+        flag &= ~static_cast<uint8_t>(Registers::Common::ModeFlags::FORCE_ARP);
+    }
+
+    // Write register back
+    write_register_u8(Registers::Common::Mode, flag);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_dest_mac(uint8_t socket, const uint8_t mac[6]) {
+    W5500_SPI_OPERATION(SOCKET_ADDRESS);
+    write_register(Registers::Socket::DestHardwareAddress, socket, mac);
+}
+
+template <typename BusT>
+void W5500<BusT>::get_socket_dest_mac(uint8_t socket, uint8_t mac[6]) {
+    W5500_SPI_OPERATION(SOCKET_ADDRESS);
+    read_register(Registers::Socket::DestHardwareAddress, socket, mac);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_buffer_size(uint8_t socket,
+                                         Registers::Socket::BufferSize size) {
+    W5500_SPI_OPERATION(SOCKET_BUFFER_SIZE);
+    set_socket_tx_buffer_size(socket, size);
+    set_socket_rx_buffer_size(socket, size);
+}
+
+template <typename BusT>
+Registers::Socket::BufferSize
+W5500<BusT>::get_socket_tx_buffer_size(uint8_t socket) {
+    W5500_SPI_OPERATION(SOCKET_BUFFER_SIZE);
+    return Registers::Socket::BufferSize(
+        read_register_u8(Registers::Socket::TxBufferSize, socket));
+}
+
+template <typename BusT>
+Registers::Socket::BufferSize
+W5500<BusT>::get_socket_rx_buffer_size(uint8_t socket) {
+    W5500_SPI_OPERATION(SOCKET_BUFFER_SIZE);
+    return Registers::Socket::BufferSize(
+        read_register_u8(Registers::Socket::RxBufferSize, socket));
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_tx_buffer_size(
+    uint8_t socket, Registers::Socket::BufferSize size) {
+    W5500_SPI_OPERATION(SOCKET_BUFFER_SIZE);
+    write_register_u8(Registers::Socket::TxBufferSize, socket,
+                      static_cast<uint8_t>(size));
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_rx_buffer_size(
+    uint8_t socket, Registers::Socket::BufferSize size) {
+    W5500_SPI_OPERATION(SOCKET_BUFFER_SIZE);
+    write_register_u8(Registers::Socket::RxBufferSize, socket,
+                      static_cast<uint8_t>(size));
+}
+
+template <typename BusT>
+void W5500<BusT>::write_register(CommonRegister reg, const uint8_t *data) {
+    access(COMMON_REGISTER_BANK, reg.offset, true, data, nullptr, reg.size);
+    if (_register_cache_enabled) {
+        _register_cache.store(reg, data);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::write_register(SocketRegister reg, uint8_t socket_n,
+                                 const uint8_t *data) {
+    access(SOCKET_REG(socket_n), reg.offset, true, data, nullptr, reg.size);
+    if (_register_cache_enabled) {
+        _register_cache.store(reg, socket_n, data);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::read_register(CommonRegister reg, uint8_t *data) {
+    if (_register_cache_enabled && _register_cache.read(reg, data)) {
+        return;
+    }
+    access(COMMON_REGISTER_BANK, reg.offset, false, nullptr, data, reg.size);
+    if (_register_cache_enabled) {
+        _register_cache.store(reg, data);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::read_register(SocketRegister reg, uint8_t socket_n,
+                                uint8_t *data) {
+    if (_register_cache_enabled && _register_cache.read(reg, socket_n, data)) {
+        return;
+    }
+    access(SOCKET_REG(socket_n), reg.offset, false, nullptr, data, reg.size);
+    if (_register_cache_enabled) {
+        _register_cache.store(reg, socket_n, data);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::enable_register_cache(bool enable) {
+    // Drop anything left over from a previous enable, since writes made
+    // while disabled were not tracked
+    _register_cache.invalidate();
+    _register_cache_enabled = enable;
+}
+
+template <typename BusT> void W5500<BusT>::resync_register_cache() {
+    W5500_SPI_OPERATION(REGISTER_CACHE);
+    uint8_t common[RegisterCache::common_size];
+    access(COMMON_REGISTER_BANK, 0x0, false, nullptr, common, sizeof(common));
+    _register_cache.load_common(common);
+
+    uint8_t block[Registers::Socket::block_size];
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        access(SOCKET_REG(socket), 0x0, false, nullptr, block, sizeof(block));
+        _register_cache.load_socket(socket, block);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::build_header(uint8_t header[3], uint8_t block,
+                               uint16_t address, bool write) {
+    // Set the address within the block
+    header[0] = (address >> 8) & 0xFF;
+    header[1] = address & 0xFF;
+    // Control byte = block select + R/W + OP mode
+    header[2] = ((block << 3) |           // Block select
+                 ((write ? 1 : 0) << 2) | // Read / Write
+                 0x0                      // Always use VDM mode
+    );
+}
+
+template <typename BusT>
+void W5500<BusT>::access(uint8_t block, uint16_t address, bool write,
+                         const uint8_t *send, uint8_t *recv, size_t size) {
+    // Send the command header and data phase under one chip select, without
+    // copying them into a single buffer first
+    uint8_t header[3];
+    build_header(header, block, address, write);
+    const Segment segments[2] = {{header, nullptr, sizeof(header)},
+                                 {send, recv, size}};
+    _bus.transfer(segments, 2);
+    count_transaction(block, size);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_interrupt_mask(
+    std::initializer_list<Registers::Common::InterruptMaskFlags> flags) {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    uint8_t mask = 0x0;
+    for (auto flag : flags) {
+        mask |= static_cast<uint8_t>(flag);
+    }
+    write_register_u8(Registers::Common::InterruptMask, mask);
+}
+
+template <typename BusT>
+Registers::Common::InterruptRegisterValue W5500<BusT>::get_interrupt_state() {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    return Registers::Common::InterruptRegisterValue(
+        read_register_u8(Registers::Common::Interrupt));
+}
+
+template <typename BusT>
+bool W5500<BusT>::has_interrupt_flag(Registers::Common::InterruptFlags flag) {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    return get_interrupt_state() & flag;
+}
+
+template <typename BusT>
+void W5500<BusT>::clear_interrupt_flag(Registers::Common::InterruptFlags flag) {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    write_register_u8(Registers::Common::Interrupt, static_cast<uint8_t>(flag));
+}
+
+template <typename BusT> void W5500<BusT>::set_retry_time(uint16_t time) {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    write_register_u16(Registers::Common::RetryTime, time);
+}
+
+template <typename BusT> uint16_t W5500<BusT>::get_retry_time() {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    return read_register_u16(Registers::Common::RetryTime);
+}
+
+template <typename BusT> void W5500<BusT>::set_retry_count(uint8_t count) {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    write_register_u8(Registers::Common::RetryCount, count);
+}
+
+template <typename BusT> uint8_t W5500<BusT>::get_retry_count() {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    return read_register_u8(Registers::Common::RetryCount);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_keepalive_interval(uint8_t socket,
+                                                uint8_t interval) {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    write_register_u8(Registers::Socket::KeepAliveTimer, socket, interval);
+}
+
+template <typename BusT>
+uint8_t W5500<BusT>::get_socket_keepalive_interval(uint8_t socket) {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    return read_register_u8(Registers::Socket::KeepAliveTimer, socket);
+}
+
+template <typename BusT> void W5500<BusT>::send_keepalive(uint8_t socket) {
+    W5500_SPI_OPERATION(RETRANSMISSION);
+    send_socket_command(socket,
+                        Registers::Socket::CommandValue::SEND_KEEPALIVE);
+}
+
+template <typename BusT> uint8_t W5500<BusT>::get_version() {
+    W5500_SPI_OPERATION(GET_VERSION);
+    return read_register_u8(Registers::Common::ChipVersion);
+}
+
+template <typename BusT> void W5500<BusT>::send(uint8_t socket) {
+    W5500_SPI_OPERATION(SEND);
+    // Trigger a send.
+    send_socket_command(socket, Registers::Socket::CommandValue::SEND);
+}
+
+template <typename BusT>
+size_t W5500<BusT>::send(uint8_t socket, const uint8_t *buffer, size_t offset,
+                         size_t size) {
+    W5500_SPI_OPERATION(SEND);
+    // Send with arguments: copy the data to the IC using write(), then
+    // immediately trigger a flush.
+    const size_t written = write(socket, buffer, offset, size);
+    send_socket_command(socket, Registers::Socket::CommandValue::SEND);
+    return written;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::write(uint8_t socket, const uint8_t *buffer,
+                          __attribute__((unused)) size_t offset, size_t size) {
+    W5500_SPI_OPERATION(WRITE);
+    TxState &tx = _tx[socket];
+    if (tx.buffer == nullptr) {
+        return write_direct(socket, buffer, size);
+    }
+
+    // Make room, or skip the buffer entirely for large writes
+    if (size > static_cast<size_t>(tx.capacity - tx.used)) {
+        commit_tx(socket);
+    }
+    if (size >= tx.capacity) {
+        return write_direct(socket, buffer, size);
+    }
+
+    // Only ask the IC for free space once what was last seen runs out
+    if (size > tx.budget) {
+        const uint16_t free_buffer_size =
+            read_register_u16(Registers::Socket::TxFreeSize, socket);
+        tx.budget = free_buffer_size > tx.used ? free_buffer_size - tx.used : 0;
+    }
+    const uint16_t bytes_to_stage = (size <= tx.budget ? size : tx.budget);
+    memcpy(&tx.buffer[tx.used], buffer, bytes_to_stage);
+    tx.used += bytes_to_stage;
+    tx.budget -= bytes_to_stage;
+    return bytes_to_stage;
+}
+
+template <typename BusT>
+void W5500<BusT>::set_tx_buffer(uint8_t socket, uint8_t *buffer,
+                                uint16_t size) {
+    commit_tx(socket);
+    TxState &tx = _tx[socket];
+    tx.buffer = size > 0 ? buffer : nullptr;
+    tx.capacity = buffer != nullptr ? size : 0;
+    tx.budget = 0;
+}
+
+template <typename BusT> void W5500<BusT>::commit_tx(uint8_t socket) {
+    W5500_SPI_OPERATION(WRITE);
+    TxState &tx = _tx[socket];
+    if (tx.used == 0) {
+        return;
+    }
+    const uint16_t write_pointer = get_tx_write_pointer(socket);
+    access(SOCKET_TX_BUFFER(socket), write_pointer, true, tx.buffer, nullptr,
+           tx.used);
+    set_tx_write_pointer(socket, write_pointer + tx.used);
+    // The budget already excludes these bytes, so it is still good
+    tx.used = 0;
+}
+
+template <typename BusT> void W5500<BusT>::reset_tx(uint8_t socket) {
+    TxState &tx = _tx[socket];
+    tx.valid = false;
+    tx.used = 0;
+    tx.budget = 0;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::write_direct(uint8_t socket, const uint8_t *buffer,
+                                 size_t size) {
+    // Anything written around the staging buffer uses up space it doesn't
+    // know about
+    _tx[socket].budget = 0;
+
+    // Get max possible tx size
+    const uint16_t free_buffer_size = get_tx_free_size(socket);
+
+    // If the buffer is full just don't even try
+    if (free_buffer_size == 0) {
+        return 0;
+    }
+
+    // Send as much data as we can. The TX write pointer has already been
+    // advanced past any data written since the last send, so this data goes
+    // straight after it.
+    const uint16_t write_pointer = get_tx_write_pointer(socket);
+    const uint16_t bytes_to_send =
+        (size <= free_buffer_size ? size : free_buffer_size);
+    access(SOCKET_TX_BUFFER(socket), write_pointer, true, buffer, nullptr,
+           bytes_to_send);
+
+    // Update the socket TX write pointer register
+    set_tx_write_pointer(socket, write_pointer + bytes_to_send);
+
+    // Return the amount of bytes that were actually sent
+    return bytes_to_send;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::read_register_u8(CommonRegister reg) {
+    uint8_t val;
+    read_register(reg, &val);
+    return val;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::read_register_u8(SocketRegister reg, uint8_t socket) {
+    uint8_t val;
+    read_register(reg, socket, &val);
+    return val;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::peek(uint8_t socket, uint8_t *buffer, size_t size) {
+    W5500_SPI_OPERATION(PEEK);
+    // Read the data from the current read pointer
+    const uint16_t read_offset = get_rx_read_pointer(socket);
+    access(SOCKET_RX_BUFFER(socket), read_offset, false, nullptr, buffer, size);
+
+    // Return the amount of bytes that were actually read
+    return size;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::peek_async(uint8_t socket, uint8_t *buffer, size_t size,
+                               Transaction &txn) {
+    W5500_SPI_OPERATION(PEEK_ASYNC);
+    // Set up the read transaction
+    const uint16_t read_offset = get_rx_read_pointer(socket);
+    build_header(txn.header, SOCKET_RX_BUFFER(socket), read_offset, false);
+    count_transaction(SOCKET_RX_BUFFER(socket), size);
+    txn.frame[0] = {txn.header, nullptr, sizeof(txn.header)};
+    txn.frame[1] = {nullptr, buffer, size};
+    txn.segments = txn.frame;
+    txn.segment_count = 2;
+
+    // Hand off to the bus
+    _bus.submit(txn);
+    return size;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::write_async(uint8_t socket, const uint8_t *buffer,
+                                __attribute__((unused)) size_t offset,
+                                size_t size, Transaction &txn) {
+    W5500_SPI_OPERATION(WRITE_ASYNC);
+    // Keep staged data ahead of this write
+    commit_tx(socket);
+
+    // Get max possible tx size
+    const uint16_t free_buffer_size = get_tx_free_size(socket);
+
+    // If the buffer is full just don't even try
+    if (free_buffer_size == 0) {
+        return 0;
+    }
+
+    // Set up the write transaction
+    _tx[socket].budget = 0;
+    const uint16_t write_pointer = get_tx_write_pointer(socket);
+    const uint16_t bytes_to_send =
+        (size <= free_buffer_size ? size : free_buffer_size);
+    build_header(txn.header, SOCKET_TX_BUFFER(socket), write_pointer, true);
+    count_transaction(SOCKET_TX_BUFFER(socket), bytes_to_send);
+    txn.frame[0] = {txn.header, nullptr, sizeof(txn.header)};
+    txn.frame[1] = {buffer, nullptr, bytes_to_send};
+    txn.segments = txn.frame;
+    txn.segment_count = 2;
+
+    // Update the socket TX write pointer register. The IC won't look at the
+    // data until SEND, which can't be issued until this transaction is done.
+    set_tx_write_pointer(socket, write_pointer + bytes_to_send);
+
+    // Hand off to the bus
+    _bus.submit(txn);
+    return bytes_to_send;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::read_register_u16(CommonRegister reg) {
+    uint8_t buf[2];
+    read_register(reg, buf);
+    return buf[0] << 8 | buf[1];
+}
+
+template <typename BusT> uint8_t W5500<BusT>::read(uint8_t socket) {
+    W5500_SPI_OPERATION(READ);
+    uint8_t val;
+    read(socket, &val, 1);
+    return val;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::read(uint8_t socket, uint8_t *buffer, size_t size) {
+    W5500_SPI_OPERATION(READ);
+    // Check if the receive buffer is valid, if it's null we
+    // want to just skip data
+    size_t read;
+    if (buffer != nullptr) {
+        // Read the data from the IC
+        read = peek(socket, buffer, size);
+    } else {
+        // Don't bother to read, just advance read pointer
+        read = size;
+    }
+
+    advance_rx(socket, read);
+    return read;
+}
+
+template <typename BusT>
+size_t W5500<BusT>::consume(uint8_t socket, ConsumeCallback callback,
+                            void *ctx, size_t max_bytes) {
+    W5500_SPI_OPERATION(CONSUME);
+    size_t available = get_rx_byte_count(socket);
+    if (available > max_bytes) {
+        available = max_bytes;
+    }
+    if (available == 0) {
+        return 0;
+    }
+
+    // Stream the data out through a small bounce buffer
+    const uint16_t read_offset = get_rx_read_pointer(socket);
+    uint8_t chunk[consume_chunk_size];
+    size_t consumed = 0;
+    while (consumed < available) {
+        size_t size = available - consumed;
+        if (size > sizeof(chunk)) {
+            size = sizeof(chunk);
+        }
+        access(SOCKET_RX_BUFFER(socket), read_offset + consumed, false,
+               nullptr, chunk, size);
+        const size_t taken = callback(chunk, size, ctx);
+        consumed += taken < size ? taken : size;
+        if (taken < size) {
+            break;
+        }
+    }
+
+    // Release everything the callback took in one go
+    advance_rx(socket, consumed);
+    return consumed;
+}
+
+template <typename BusT> size_t W5500<BusT>::flush(uint8_t socket) {
+    W5500_SPI_OPERATION(FLUSH);
+    // Get the pending data size
+    const uint16_t read_ptr = get_rx_read_pointer(socket);
+    const uint16_t write_ptr = get_rx_write_pointer(socket);
+
+    // Update the socket RX read pointer register
+    set_rx_read_pointer(socket, write_ptr);
+
+    // Call RECV to update the chip state
+    send_socket_command(socket, Registers::Socket::CommandValue::RECV);
+
+    // Return the number of discarded bytes
+    return write_ptr - read_ptr;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::read_register_u16(SocketRegister reg, uint8_t socket) {
+    uint8_t buf[2];
+    read_register(reg, socket, buf);
+    return buf[0] << 8 | buf[1];
+}
+
+template <typename BusT>
+void W5500<BusT>::write_register_u8(CommonRegister reg, uint8_t val) {
+    write_register(reg, &val);
+}
+
+template <typename BusT>
+void W5500<BusT>::write_register_u8(SocketRegister reg, uint8_t socket,
+                                    uint8_t val) {
+    write_register(reg, socket, &val);
+}
+
+template <typename BusT>
+void W5500<BusT>::write_register_u16(CommonRegister reg, uint16_t value) {
+    uint8_t buf[2];
+    buf[0] = (value >> 8) & 0xFF;
+    buf[1] = value & 0xFF;
+    write_register(reg, buf);
+}
+
+template <typename BusT>
+void W5500<BusT>::write_register_u16(SocketRegister reg, uint8_t socket,
+                                     uint16_t value) {
+    uint8_t buf[2];
+    buf[0] = (value >> 8) & 0xFF;
+    buf[1] = value & 0xFF;
+    write_register(reg, socket, buf);
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::get_tx_free_size(uint8_t socket) {
+    W5500_SPI_OPERATION(GET_TX_FREE_SIZE);
+    // Staged data will take up space too
+    const uint16_t free_buffer_size =
+        read_register_u16(Registers::Socket::TxFreeSize, socket);
+    const uint16_t staged = _tx[socket].used;
+    return free_buffer_size > staged ? free_buffer_size - staged : 0;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::get_tx_read_pointer(uint8_t socket) {
+    W5500_SPI_OPERATION(TX_POINTERS);
+    return read_register_u16(Registers::Socket::TxReadPointer, socket);
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::get_tx_write_pointer(uint8_t socket) {
+    W5500_SPI_OPERATION(TX_POINTERS);
+    TxState &tx = _tx[socket];
+    if (!tx.valid) {
+        tx.write_pointer =
+            read_register_u16(Registers::Socket::TxWritePointer, socket);
+        tx.valid = true;
+    }
+    return tx.write_pointer;
+}
+
+template <typename BusT>
+void W5500<BusT>::set_tx_write_pointer(uint8_t socket, uint16_t offset) {
+    W5500_SPI_OPERATION(TX_POINTERS);
+    write_register_u16(Registers::Socket::TxWritePointer, socket, offset);
+    _tx[socket].write_pointer = offset;
+    _tx[socket].valid = true;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::get_rx_byte_count(uint8_t socket) {
+    W5500_SPI_OPERATION(GET_RX_BYTE_COUNT);
+    // The IC still counts data that has been read but not released
+    const uint16_t pending = _rx[socket].pending;
+    const uint16_t count =
+        read_register_u16(Registers::Socket::RxReceivedSize, socket) - pending;
+
+    // Once the reader has caught up, give the space back straight away
+    if (count == 0 && pending > 0) {
+        commit_rx(socket);
+    }
+    return count;
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::get_rx_read_pointer(uint8_t socket) {
+    W5500_SPI_OPERATION(RX_POINTERS);
+    RxState &rx = _rx[socket];
+    if (!rx.valid) {
+        rx.read_pointer =
+            read_register_u16(Registers::Socket::RxReadPointer, socket);
+        rx.valid = true;
+    }
+    return rx.read_pointer;
+}
+
+template <typename BusT>
+void W5500<BusT>::set_rx_read_pointer(uint8_t socket, uint16_t offset) {
+    W5500_SPI_OPERATION(RX_POINTERS);
+    write_register_u16(Registers::Socket::RxReadPointer, socket, offset);
+    _rx[socket].read_pointer = offset;
+    _rx[socket].pending = 0;
+    _rx[socket].valid = true;
+}
+
+template <typename BusT>
+void W5500<BusT>::set_rx_commit_threshold(uint16_t bytes) {
+    _rx_commit_threshold = bytes;
+}
+
+template <typename BusT> void W5500<BusT>::commit_rx(uint8_t socket) {
+    W5500_SPI_OPERATION(RX_POINTERS);
+    if (_rx[socket].pending == 0) {
+        return;
+    }
+    set_rx_read_pointer(socket, _rx[socket].read_pointer);
+    send_socket_command(socket, Registers::Socket::CommandValue::RECV);
+}
+
+template <typename BusT>
+void W5500<BusT>::advance_rx(uint8_t socket, size_t size) {
+    RxState &rx = _rx[socket];
+    // Make sure the pointer is known before moving it
+    get_rx_read_pointer(socket);
+    rx.read_pointer += size;
+    rx.pending += size;
+    if (rx.pending >= _rx_commit_threshold) {
+        commit_rx(socket);
+    }
+}
+
+template <typename BusT> void W5500<BusT>::invalidate_rx() {
+    for (size_t socket = 0; socket < max_sockets; socket++) {
+        _rx[socket] = RxState();
+    }
+}
+
+template <typename BusT>
+uint16_t W5500<BusT>::get_rx_write_pointer(uint8_t socket) {
+    W5500_SPI_OPERATION(RX_POINTERS);
+    return read_register_u16(Registers::Socket::RxWritePointer, socket);
+}
+
+template <typename BusT>
+Registers::Socket::InterruptRegisterValue
+W5500<BusT>::get_socket_interrupt_flags(uint8_t socket) {
+    W5500_SPI_OPERATION(SOCKET_INTERRUPTS);
+    const uint8_t val = read_register_u8(Registers::Socket::Interrupt, socket);
+    return Registers::Socket::InterruptRegisterValue(val);
+}
+
+template <typename BusT>
+bool
+W5500<BusT>::socket_has_interrupt_flag(uint8_t socket,
+                                       Registers::Socket::InterruptFlags flag) {
+    W5500_SPI_OPERATION(SOCKET_INTERRUPTS);
+    return get_socket_interrupt_flags(socket) & flag;
+}
+
+template <typename BusT>
+void W5500<BusT>::clear_socket_interrupt_flag(
+    uint8_t socket, Registers::Socket::InterruptFlags flag) {
+    W5500_SPI_OPERATION(SOCKET_INTERRUPTS);
+    write_register_u8(Registers::Socket::Interrupt, socket,
+                      static_cast<uint8_t>(flag));
+}
+
+template <typename BusT>
+void W5500<BusT>::clear_socket_interrupt_flags(uint8_t socket, uint8_t flags) {
+    W5500_SPI_OPERATION(SOCKET_INTERRUPTS);
+    write_register_u8(Registers::Socket::Interrupt, socket, flags);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_interrupt_mask(
+    uint8_t socket,
+    std::initializer_list<Registers::Socket::InterruptMaskFlags> flags) {
+    uint8_t mask = 0x0;
+    for (auto flag : flags) {
+        mask |= static_cast<uint8_t>(flag);
+    }
+    set_socket_interrupt_mask(socket, mask);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_interrupt_mask(uint8_t socket, uint8_t mask) {
+    W5500_SPI_OPERATION(SOCKET_INTERRUPTS);
+    write_register_u8(Registers::Socket::InterruptMask, socket, mask);
+}
+
+template <typename BusT>
+void W5500<BusT>::set_socket_interrupt_enable(uint8_t sockets) {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    write_register_u8(Registers::Common::SocketInterruptMask, sockets);
+}
+
+template <typename BusT> uint8_t W5500<BusT>::get_socket_interrupt_enable() {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    return read_register_u8(Registers::Common::SocketInterruptMask);
+}
+
+template <typename BusT>
+uint8_t W5500<BusT>::get_pending_socket_interrupts() {
+    W5500_SPI_OPERATION(INTERRUPTS);
+    return read_register_u8(Registers::Common::SocketInterrupt);
+}
+
+template <typename BusT> bool W5500<BusT>::take_interrupt() {
+    if (!_bus.has_pending_interrupt()) {
+        return false;
+    }
+    _bus.clear_interrupt_flag();
+    return true;
+}
+
+template <typename BusT>
+SocketSnapshot W5500<BusT>::snapshot_socket(uint8_t socket) {
+    W5500_SPI_OPERATION(SNAPSHOT);
+    // Burst read the whole register block
+    uint8_t block[Registers::Socket::block_size];
+    access(SOCKET_REG(socket), 0x0, false, nullptr, block, sizeof(block));
+    _snapshot_counters.snapshots++;
+    _snapshot_counters.spi_transactions++;
+    _snapshot_counters.spi_bytes += 3 + sizeof(block);
+    if (_register_cache_enabled) {
+        _register_cache.load_socket(socket, block);
+    }
+
+    // Decode it, keeping track of what reading each register on its own
+    // would have cost
+    uint32_t registers = 0;
+    uint32_t register_bytes = 0;
+    auto field = [&](const SocketRegister &reg) -> uint8_t * {
+        registers++;
+        register_bytes += 3 + reg.size;
+        return &block[reg.offset];
+    };
+    auto u16 = [](const uint8_t *data) -> uint16_t {
+        return data[0] << 8 | data[1];
+    };
+
+    SocketSnapshot snapshot;
+    snapshot.mode = *field(Registers::Socket::Mode);
+    snapshot.status =
+        Registers::Socket::StatusValue(*field(Registers::Socket::Status));
+    snapshot.interrupt_flags = *field(Registers::Socket::Interrupt);
+    snapshot.interrupt_mask = *field(Registers::Socket::InterruptMask);
+    snapshot.source_port = u16(field(Registers::Socket::SourcePort));
+    memcpy(snapshot.dest_mac, field(Registers::Socket::DestHardwareAddress),
+           6);
+    memcpy(snapshot.dest_ip, field(Registers::Socket::DestIPAddress), 4);
+    snapshot.dest_port = u16(field(Registers::Socket::DestPort));
+    snapshot.max_segment_size = u16(field(Registers::Socket::MaxSegmentSize));
+    snapshot.rx_buffer_size = Registers::Socket::BufferSize(
+        *field(Registers::Socket::RxBufferSize));
+    snapshot.tx_buffer_size = Registers::Socket::BufferSize(
+        *field(Registers::Socket::TxBufferSize));
+    snapshot.tx_free_size = u16(field(Registers::Socket::TxFreeSize));
+    snapshot.tx_free_size = snapshot.tx_free_size > _tx[socket].used
+                                ? snapshot.tx_free_size - _tx[socket].used
+                                : 0;
+    snapshot.tx_read_pointer = u16(field(Registers::Socket::TxReadPointer));
+    snapshot.tx_write_pointer = u16(field(Registers::Socket::TxWritePointer));
+    snapshot.rx_byte_count = u16(field(Registers::Socket::RxReceivedSize));
+    snapshot.rx_read_pointer = u16(field(Registers::Socket::RxReadPointer));
+    // Account for reads that haven't been released to the IC yet
+    if (_rx[socket].pending > 0) {
+        snapshot.rx_byte_count -= _rx[socket].pending;
+        snapshot.rx_read_pointer = _rx[socket].read_pointer;
+    }
+    snapshot.rx_write_pointer = u16(field(Registers::Socket::RxWritePointer));
+    snapshot.keepalive_timer = *field(Registers::Socket::KeepAliveTimer);
+
+    _snapshot_counters.individual_transactions += registers;
+    _snapshot_counters.individual_bytes += register_bytes;
+    return snapshot;
+}
+
+template <typename BusT>
+void W5500<BusT>::snapshot_all_sockets(SocketSnapshot snapshots[max_sockets]) {
+    W5500_SPI_OPERATION(SNAPSHOT);
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        snapshots[socket] = snapshot_socket(socket);
+    }
+}
+
+template <typename BusT>
+void W5500<BusT>::set_phy_mode(Registers::Common::PhyOperationMode mode) {
+    W5500_SPI_OPERATION(SET_PHY_MODE);
+    uint8_t current_phy_settings =
+        read_register_u8(Registers::Common::PhyConfig);
+    const uint8_t new_phy_settings = (
+        // Clear the old mask from the phy register
+        (current_phy_settings & ~(0b111 << 3)) |
+        // Set the operation mode bit to use software control instead of HW pins
+        static_cast<uint8_t>(
+            Registers::Common::PhyConfigFlags::OPERATION_MODE) |
+        // Set the new mode mask
+        (static_cast<uint8_t>(mode) << 3));
+    write_register_u8(Registers::Common::PhyConfig, new_phy_settings);
+
+    // After changing the PHY settings, we need to reset the PHY by
+    // clearing the RESET bit
+    current_phy_settings = read_register_u8(Registers::Common::PhyConfig);
+    write_register_u8(
+        Registers::Common::PhyConfig,
+        new_phy_settings &
+            ~(static_cast<uint8_t>(Registers::Common::PhyConfigFlags::RESET)));
+
+    // And then setting the reset bit again
+    current_phy_settings = read_register_u8(Registers::Common::PhyConfig);
+    write_register_u8(Registers::Common::PhyConfig, new_phy_settings);
+}
+
+} // namespace Static
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_STATIC_W5500_H_
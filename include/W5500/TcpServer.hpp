@@ -0,0 +1,103 @@
+#ifndef _W5500__W5500_TCPSERVER_H_
+#define _W5500__W5500_TCPSERVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+
+// TCP server on a pool of hardware sockets all listening on one port.
+// Each W5500 socket carries a single connection, so a server on one socket
+// refuses every connection from the moment a client connects until the
+// socket is closed and listening again. Keeping several sockets armed lets
+// a burst of clients connect at once, and freed sockets are put straight
+// back into LISTEN.
+//
+// poll() checks the sockets that are not handed out, accept() returns the
+// number of a socket with an established connection (construct a TcpSocket
+// on it to use it), and release() disconnects it and returns it to the pool.
+class TcpServer {
+  public:
+    struct Stats {
+        // Connections established, and handed out by accept()
+        uint32_t connections = 0;
+        uint32_t accepted = 0;
+        // Connections that closed again before they were accepted, or
+        // handshakes that failed
+        uint32_t aborted = 0;
+        // Times a socket was put (back) into LISTEN
+        uint32_t arms = 0;
+        // Polls that found no socket listening, while any connection
+        // attempt would have been refused by the IC
+        uint32_t saturated_polls = 0;
+        // Time from a connection being seen by poll() to it being accepted
+        uint64_t accept_latency_total_ms = 0;
+        uint32_t accept_latency_max_ms = 0;
+    };
+
+    TcpServer(W5500 &driver, uint16_t port) : _driver(driver), _port(port) {}
+
+    // Add a hardware socket to the pool. It is armed by begin().
+    bool add_socket(uint8_t socket);
+    // Put every socket in the pool into LISTEN
+    void begin();
+    // Close every socket in the pool, including accepted ones. poll()
+    // leaves them closed until the next begin().
+    void end();
+
+    // Pick up new connections, and re-arm sockets that have been freed
+    void poll();
+
+    // Take the longest waiting established connection. Returns its socket
+    // number, or -1 if there is none.
+    int accept();
+    // Return an accepted socket to the pool. A graceful release sends FIN
+    // and re-arms the socket once it has closed; otherwise the connection
+    // is dropped and the socket listens again immediately.
+    void release(uint8_t socket, bool graceful = true);
+
+    // Connections waiting for accept(), and sockets currently listening
+    size_t pending() const;
+    size_t listening() const;
+
+    const Stats &stats() const { return _stats; }
+    void reset_stats() { _stats = Stats(); }
+
+  private:
+    enum class SlotState : uint8_t {
+        // Not part of the pool
+        UNUSED,
+        // In the pool, but closed until begin()
+        STOPPED,
+        LISTENING,
+        // Connected, waiting for accept()
+        READY,
+        ACCEPTED,
+        // Disconnecting after release()
+        CLOSING,
+    };
+
+    struct Slot {
+        SlotState state = SlotState::UNUSED;
+        // When the connection was seen
+        uint64_t ready_ms = 0;
+    };
+
+    W5500 &_driver;
+    const uint16_t _port;
+    Slot _slots[max_sockets];
+    Stats _stats;
+
+    // Disallow copying
+    TcpServer(const TcpServer &);
+    TcpServer &operator=(const TcpServer &);
+
+    void arm(uint8_t socket);
+    size_t count(SlotState state) const;
+};
+
+} // namespace W5500
+
+#endif // #ifndef _W5500__W5500_TCPSERVER_H_
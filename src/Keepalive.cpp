@@ -0,0 +1,70 @@
+#include <W5500/Keepalive.hpp>
+
+namespace W5500 {
+
+uint32_t KeepaliveMonitor::set_retransmission(uint16_t retry_time,
+                                              uint8_t retry_count) {
+    _driver.set_retry_time(retry_time);
+    _driver.set_retry_count(retry_count);
+    return retransmission_timeout_ms();
+}
+
+uint32_t KeepaliveMonitor::retransmission_timeout_ms() {
+    const uint32_t timeout = Registers::Common::tcp_timeout(
+        _driver.get_retry_time(), _driver.get_retry_count());
+    // Timeout is in units of 100us
+    return (timeout + 9) / 10;
+}
+
+void KeepaliveMonitor::watch(uint8_t socket, uint32_t idle_ms) {
+    Watch &watch = _watches[socket];
+    watch = Watch();
+    watch.idle_ms = idle_ms;
+    if (idle_ms > 0) {
+        const SocketSnapshot snapshot = _driver.snapshot_socket(socket);
+        watch.tx_read_pointer = snapshot.tx_read_pointer;
+        watch.rx_write_pointer = snapshot.rx_write_pointer;
+        watch.next_check_ms = _driver.bus().millis() + idle_ms;
+    }
+}
+
+void KeepaliveMonitor::poll() {
+    using Registers::Socket::StatusValue;
+    const uint64_t now = _driver.bus().millis();
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        Watch &watch = _watches[socket];
+        if (watch.idle_ms == 0 || now < watch.next_check_ms) {
+            continue;
+        }
+
+        _stats.checks++;
+        const SocketSnapshot snapshot = _driver.snapshot_socket(socket);
+        if (snapshot.status == StatusValue::CLOSED) {
+            watch.idle_ms = 0;
+            _stats.dead_peers++;
+            if (_callback != nullptr) {
+                _callback(socket, _callback_ctx);
+            }
+            continue;
+        }
+
+        const bool idle = snapshot.tx_read_pointer == watch.tx_read_pointer &&
+                          snapshot.rx_write_pointer == watch.rx_write_pointer;
+        watch.tx_read_pointer = snapshot.tx_read_pointer;
+        watch.rx_write_pointer = snapshot.rx_write_pointer;
+        if (idle && !watch.probing &&
+            snapshot.status == StatusValue::ESTABLISHED) {
+            _driver.send_keepalive(socket);
+            _stats.keepalives++;
+            // Look again as soon as the keepalive could have timed out
+            watch.probing = true;
+            watch.next_check_ms = now + retransmission_timeout_ms() + 1;
+        } else {
+            // Still connected, so the peer answered any keepalive
+            watch.probing = false;
+            watch.next_check_ms = now + watch.idle_ms;
+        }
+    }
+}
+
+} // namespace W5500
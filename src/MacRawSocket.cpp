@@ -0,0 +1,111 @@
+#include <W5500/Socket.hpp>
+#include <W5500/W5500.hpp>
+
+namespace W5500 {
+
+const uint16_t macraw_header_size = FrameRing::header_size;
+
+bool MacRawSocket::init() {
+    _driver.set_socket_mode(
+        _sockfd,
+        SocketMode(static_cast<uint8_t>(SocketMode::MACRAW) | _mode_flags));
+    _driver.send_socket_command(_sockfd, Registers::Socket::CommandValue::OPEN);
+    return ready();
+}
+
+bool MacRawSocket::ready() {
+    Registers::Socket::StatusValue status = _driver.get_socket_status(_sockfd);
+    return status == Registers::Socket::StatusValue::MACRAW;
+}
+
+bool MacRawSocket::has_frame() {
+    return _driver.get_rx_byte_count(_sockfd) > macraw_header_size;
+}
+
+int MacRawSocket::read_frame(uint8_t *buffer, size_t size) {
+    const size_t pending = _driver.get_rx_byte_count(_sockfd);
+    if (pending <= macraw_header_size) {
+        return -1;
+    }
+
+    uint8_t header[macraw_header_size];
+    _driver.read(_sockfd, header, sizeof(header));
+    const size_t total = header[0] << 8 | header[1];
+    if (total <= macraw_header_size || total > pending) {
+        // Not a valid frame header, the buffer can't be trusted
+        _driver.flush(_sockfd);
+        return -1;
+    }
+    const uint16_t length = total - macraw_header_size;
+
+    // Read what fits, and drop the rest
+    if (size > length) {
+        size = length;
+    }
+    _driver.read(_sockfd, buffer, size);
+    if (size < length) {
+        _driver.read(_sockfd, nullptr, length - size);
+    }
+    return length;
+}
+
+void MacRawSocket::set_clock(CaptureClock clock, void *ctx) {
+    _clock = clock;
+    _clock_ctx = ctx;
+}
+
+int MacRawSocket::capture(FrameRing &ring) {
+    uint32_t seconds = 0;
+    uint32_t microseconds = 0;
+    if (_clock != nullptr) {
+        _clock(seconds, microseconds, _clock_ctx);
+    }
+
+    size_t pending = _driver.get_rx_byte_count(_sockfd);
+    int captured = 0;
+    while (pending > macraw_header_size && !ring.full()) {
+        // Read as much as fits into the next slot in one burst. The first
+        // frame is then already in place, and any others that came with it
+        // are copied out to the slots after.
+        uint8_t *const chunk = ring.next_slot();
+        const size_t size =
+            pending < ring.slot_size() ? pending : ring.slot_size();
+        _driver.peek(_sockfd, chunk, size);
+
+        size_t offset = 0;
+        while (offset + macraw_header_size <= size && !ring.full()) {
+            const uint8_t *frame = &chunk[offset];
+            const size_t total = frame[0] << 8 | frame[1];
+            if (total <= macraw_header_size || total > pending - offset) {
+                // Not a valid frame header, the buffer can't be trusted
+                _driver.flush(_sockfd);
+                return captured;
+            }
+
+            const uint16_t length = total - macraw_header_size;
+            if (offset + total <= size) {
+                if (offset > 0) {
+                    memcpy(ring.next_slot(), frame, total);
+                }
+                ring.push(length, length, seconds, microseconds);
+            } else if (offset == 0) {
+                // Longer than a slot, keep the start of it
+                ring.push(length, size - macraw_header_size, seconds,
+                          microseconds);
+            } else {
+                // Cut off, it will start the next burst
+                break;
+            }
+            offset += total;
+            captured++;
+        }
+
+        // Release the frames taken, including the unread end of a
+        // truncated one
+        _driver.read(_sockfd, nullptr, offset);
+        pending -= offset;
+    }
+    return captured;
+}
+
+} // namespace W5500
@@ -0,0 +1,104 @@
+#include <W5500/Manager.hpp>
+
+namespace W5500 {
+
+int Manager::add_chip(W5500 &driver) {
+    if (_chip_count == max_chips) {
+        return -1;
+    }
+    _chips[_chip_count] = &driver;
+    _in_use[_chip_count] = 0;
+    return _chip_count++;
+}
+
+size_t Manager::sockets_used(uint8_t mask) {
+    return __builtin_popcount(mask);
+}
+
+size_t Manager::free_sockets() const {
+    size_t used = 0;
+    for (size_t chip = 0; chip < _chip_count; chip++) {
+        used += sockets_used(_in_use[chip]);
+    }
+    return socket_count() - used;
+}
+
+bool Manager::in_use(size_t id) const {
+    const size_t chip = id / max_sockets;
+    if (chip >= _chip_count) {
+        return false;
+    }
+    return _in_use[chip] & (1 << (id % max_sockets));
+}
+
+SocketHandle Manager::allocate() {
+    // Pick the chip with the fewest sockets taken
+    size_t best = max_chips;
+    for (size_t chip = 0; chip < _chip_count; chip++) {
+        if (_in_use[chip] == 0xFF) {
+            continue;
+        }
+        if (best == max_chips ||
+            sockets_used(_in_use[chip]) < sockets_used(_in_use[best])) {
+            best = chip;
+        }
+    }
+    if (best == max_chips) {
+        return SocketHandle();
+    }
+    return allocate_on(best);
+}
+
+SocketHandle Manager::allocate_on(size_t chip) {
+    if (chip >= _chip_count) {
+        return SocketHandle();
+    }
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        if (!(_in_use[chip] & (1 << socket))) {
+            _in_use[chip] |= 1 << socket;
+            return handle(chip * max_sockets + socket);
+        }
+    }
+    return SocketHandle();
+}
+
+void Manager::release(const SocketHandle &handle) {
+    // Ignore handles that were not handed out by this manager
+    if (!handle.valid() || handle.chip >= _chip_count ||
+        handle.driver != _chips[handle.chip] ||
+        handle.socket >= max_sockets) {
+        return;
+    }
+    _in_use[handle.chip] &= ~(1 << handle.socket);
+}
+
+SocketHandle Manager::handle(size_t id) const {
+    SocketHandle handle;
+    const size_t chip = id / max_sockets;
+    if (chip < _chip_count) {
+        handle.driver = _chips[chip];
+        handle.chip = chip;
+        handle.socket = id % max_sockets;
+    }
+    return handle;
+}
+
+void Manager::poll(SocketCallback callback, void *ctx) {
+    if (_chip_count == 0) {
+        return;
+    }
+    for (size_t i = 0; i < _chip_count; i++) {
+        const size_t chip = (_next_chip + i) % _chip_count;
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            if (!(_in_use[chip] & (1 << socket))) {
+                continue;
+            }
+            const SocketSnapshot snapshot =
+                _chips[chip]->snapshot_socket(socket);
+            callback(handle(chip * max_sockets + socket), snapshot, ctx);
+        }
+    }
+    _next_chip = (_next_chip + 1) % _chip_count;
+}
+
+} // namespace W5500
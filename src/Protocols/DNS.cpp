@@ -32,11 +32,15 @@ void Client::update() {
         _socket.clear_interrupt_flag(Registers::Socket::InterruptFlags::RECV);
 
         // Try and parse the response
-        while (parse_packet())
-            ;
+        receive();
     }
 }
 
+void Client::receive() {
+    while (parse_packet())
+        ;
+}
+
 bool Client::parse_packet() {
     uint8_t source_ip[4];
     uint16_t source_port;
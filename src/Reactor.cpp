@@ -0,0 +1,65 @@
+#include <W5500/Reactor.hpp>
+
+namespace W5500 {
+
+void Reactor::attach(uint8_t socket, Handler handler, void *ctx,
+                     uint8_t events) {
+    Registration &registration = _handlers[socket];
+    registration.handler = handler;
+    registration.ctx = ctx;
+    registration.events = events;
+    _driver.set_socket_interrupt_mask(socket, events);
+    _enabled |= 1 << socket;
+    _driver.set_socket_interrupt_enable(_enabled);
+}
+
+void Reactor::detach(uint8_t socket) {
+    _handlers[socket] = Registration();
+    _enabled &= ~(1 << socket);
+    _driver.set_socket_interrupt_enable(_enabled);
+}
+
+int Reactor::poll() {
+    _stats.polls++;
+    if (_interrupt_driven && !_driver.take_interrupt()) {
+        return 0;
+    }
+    _stats.wakeups++;
+
+    // INTn is level triggered, but the bus only sees the edge. Keep going
+    // until SIR reads back empty, so that the line is deasserted and events
+    // that arrive while handlers run raise a fresh interrupt.
+    int dispatched = 0;
+    for (;;) {
+        const uint8_t pending =
+            _driver.get_pending_socket_interrupts() & _enabled;
+        int handled = 0;
+        for (uint8_t socket = 0; socket < max_sockets; socket++) {
+            if (!(pending & (1 << socket))) {
+                continue;
+            }
+            const Registration &registration = _handlers[socket];
+            const uint8_t flags =
+                _driver.get_socket_interrupt_flags(socket).value() &
+                registration.events;
+            if (flags == 0) {
+                continue;
+            }
+            _driver.clear_socket_interrupt_flags(socket, flags);
+            registration.handler(socket, flags, registration.ctx);
+            handled++;
+        }
+        if (handled == 0) {
+            break;
+        }
+        dispatched += handled;
+    }
+
+    if (dispatched == 0) {
+        _stats.spurious++;
+    }
+    _stats.dispatches += dispatched;
+    return dispatched;
+}
+
+} // namespace W5500
@@ -0,0 +1,226 @@
+#include <string.h>
+
+#include <W5500/RttEstimator.hpp>
+
+namespace W5500 {
+
+namespace {
+// Timeout for a destination that has not been measured yet, the chip's
+// default retry time
+const uint32_t initial_rto_ms = 200;
+// Largest timeout RTR can hold, in milliseconds
+const uint32_t rtr_max_ms = 0xFFFF / 10;
+} // namespace
+
+void RttEstimator::set_rto_limits(uint32_t min_ms, uint32_t max_ms) {
+    _min_rto_ms = min_ms > 0 ? min_ms : 1;
+    _max_rto_ms = max_ms < rtr_max_ms ? max_ms : rtr_max_ms;
+    if (_max_rto_ms < _min_rto_ms) {
+        _max_rto_ms = _min_rto_ms;
+    }
+    for (Destination &destination : _destinations) {
+        destination.rto_ms = clamp(destination.rto_ms);
+    }
+}
+
+void RttEstimator::begin(uint8_t socket, const uint8_t ip[4]) {
+    Destination &destination = lookup(ip);
+    Operation &operation = _operations[socket];
+    operation.pending = false;
+
+    // Cover every other operation still waiting on a retransmission timer
+    uint32_t rto_ms = destination.rto_ms;
+    for (const Operation &other : _operations) {
+        if (!other.pending) {
+            continue;
+        }
+        const Destination *other_destination = find(other.ip);
+        const uint32_t other_rto_ms = other_destination != nullptr
+                                          ? other_destination->rto_ms
+                                          : other.rto_ms;
+        if (other_rto_ms > rto_ms) {
+            rto_ms = other_rto_ms;
+        }
+    }
+    apply(rto_ms);
+
+    memcpy(operation.ip, ip, 4);
+    operation.pending = true;
+    operation.started_ms = _driver.bus().millis();
+    operation.rto_ms = rto_ms;
+    update_socket_stats(socket, destination);
+}
+
+void RttEstimator::event(uint8_t socket, uint8_t flags) {
+    using Registers::Socket::InterruptFlags;
+    Operation &operation = _operations[socket];
+    if (!operation.pending) {
+        return;
+    }
+
+    const uint8_t completed = static_cast<uint8_t>(InterruptFlags::CONNECT) |
+                              static_cast<uint8_t>(InterruptFlags::SEND_OK);
+    Destination *destination = find(operation.ip);
+    SocketStats &stats = _socket_stats[socket];
+    if (flags & static_cast<uint8_t>(InterruptFlags::TIMEOUT)) {
+        operation.pending = false;
+        stats.timeouts++;
+        if (destination != nullptr) {
+            back_off(*destination);
+        }
+    } else if (flags & completed) {
+        operation.pending = false;
+        const uint64_t elapsed = _driver.bus().millis() - operation.started_ms;
+        if (destination == nullptr) {
+            // Replaced while the operation was in progress
+            return;
+        }
+        if (elapsed >= operation.rto_ms) {
+            // Retried at least once, so the sample can't be trusted
+            stats.ambiguous++;
+            back_off(*destination);
+        } else {
+            stats.samples++;
+            _stats.samples++;
+            sample(*destination, uint32_t(elapsed));
+        }
+    } else if (flags & static_cast<uint8_t>(InterruptFlags::DISCONNECT)) {
+        operation.pending = false;
+        return;
+    } else {
+        return;
+    }
+
+    if (destination != nullptr) {
+        update_socket_stats(socket, *destination);
+    }
+}
+
+uint32_t RttEstimator::rto_ms(const uint8_t ip[4]) const {
+    const Destination *destination = find(ip);
+    return destination != nullptr ? destination->rto_ms
+                                  : clamp(initial_rto_ms);
+}
+
+RttEstimator::SocketStats RttEstimator::socket_stats(uint8_t socket) const {
+    return _socket_stats[socket];
+}
+
+void RttEstimator::reset_stats() {
+    _stats = Stats();
+    // Keep the estimates, which are state rather than counters
+    for (SocketStats &stats : _socket_stats) {
+        stats.samples = 0;
+        stats.ambiguous = 0;
+        stats.timeouts = 0;
+    }
+}
+
+RttEstimator::Destination *RttEstimator::find(const uint8_t ip[4]) {
+    for (Destination &destination : _destinations) {
+        if (destination.valid && memcmp(destination.ip, ip, 4) == 0) {
+            return &destination;
+        }
+    }
+    return nullptr;
+}
+
+const RttEstimator::Destination *
+RttEstimator::find(const uint8_t ip[4]) const {
+    return const_cast<RttEstimator *>(this)->find(ip);
+}
+
+RttEstimator::Destination &RttEstimator::lookup(const uint8_t ip[4]) {
+    Destination *destination = find(ip);
+    if (destination == nullptr) {
+        // Take a free entry, or else the least recently used
+        destination = &_destinations[0];
+        for (Destination &candidate : _destinations) {
+            if (!candidate.valid) {
+                destination = &candidate;
+                break;
+            }
+            if (candidate.last_used < destination->last_used) {
+                destination = &candidate;
+            }
+        }
+        *destination = Destination();
+        memcpy(destination->ip, ip, 4);
+        destination->valid = true;
+        destination->rto_ms = clamp(initial_rto_ms);
+    }
+    destination->last_used = ++_uses;
+    return *destination;
+}
+
+uint32_t RttEstimator::clamp(uint32_t rto_ms) const {
+    if (rto_ms < _min_rto_ms) {
+        return _min_rto_ms;
+    }
+    return rto_ms > _max_rto_ms ? _max_rto_ms : rto_ms;
+}
+
+void RttEstimator::sample(Destination &destination, uint32_t rtt_ms) {
+    const int32_t rtt = int32_t(rtt_ms);
+    if (!destination.measured) {
+        destination.measured = true;
+        destination.srtt_x8 = rtt << 3;
+        destination.rttvar_x4 = rtt << 1;
+    } else {
+        // SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4
+        int32_t delta = rtt - (destination.srtt_x8 >> 3);
+        destination.srtt_x8 += delta;
+        if (delta < 0) {
+            delta = -delta;
+        }
+        destination.rttvar_x4 += delta - (destination.rttvar_x4 >> 2);
+    }
+    // RTO = SRTT + max(G, 4 * RTTVAR), with a clock granularity of 1ms
+    const int32_t variance =
+        destination.rttvar_x4 > 1 ? destination.rttvar_x4 : 1;
+    destination.rto_ms =
+        clamp(uint32_t(((destination.srtt_x8 + 4) >> 3) + variance));
+}
+
+void RttEstimator::back_off(Destination &destination) {
+    destination.rto_ms = clamp(destination.rto_ms * 2);
+}
+
+void RttEstimator::update_socket_stats(uint8_t socket,
+                                       const Destination &destination) {
+    SocketStats &stats = _socket_stats[socket];
+    stats.srtt_ms = uint32_t((destination.srtt_x8 + 4) >> 3);
+    stats.rttvar_ms = uint32_t((destination.rttvar_x4 + 2) >> 2);
+    stats.rto_ms = destination.rto_ms;
+}
+
+void RttEstimator::apply(uint32_t rto_ms) {
+    const uint16_t retry_time = uint16_t(rto_ms * 10);
+    if (retry_time == _retry_time && _give_up_ms == _applied_give_up_ms) {
+        _stats.profile_skips++;
+        return;
+    }
+
+    // As many retries as fit in the give up time
+    uint8_t retry_count = 0;
+    while (retry_count < 0xFF &&
+           Registers::Common::tcp_timeout(retry_time, retry_count + 1) <=
+               uint64_t(_give_up_ms) * 10) {
+        retry_count++;
+    }
+
+    // Nothing has been written until RTR has
+    const bool written = _retry_time != 0;
+    _stats.profile_writes++;
+    if (retry_time != _retry_time) {
+        _driver.set_retry_time(retry_time);
+        _retry_time = retry_time;
+    }
+    if (!written || retry_count != _retry_count) {
+        _driver.set_retry_count(retry_count);
+        _retry_count = retry_count;
+    }
+    _applied_give_up_ms = _give_up_ms;
+}
+
+} // namespace W5500
@@ -56,12 +56,20 @@ int Socket::read(uint8_t *buffer, size_t size) {
     return _driver.read(_sockfd, buffer, size);
 }
 
+int Socket::consume(ConsumeCallback callback, void *ctx, size_t max_bytes) {
+    return _driver.consume(_sockfd, callback, ctx, max_bytes);
+}
+
 int Socket::write(const uint8_t *buffer, size_t size) {
     const int ret = _driver.write(_sockfd, buffer, _write_offset, size);
     _write_offset += ret;
     return ret;
 }
 
+void Socket::set_tx_buffer(uint8_t *buffer, uint16_t size) {
+    _driver.set_tx_buffer(_sockfd, buffer, size);
+}
+
 int Socket::send(const uint8_t *buffer, size_t size) {
     const int ret = _driver.send(_sockfd, buffer, _write_offset, size);
     _write_offset = 0;
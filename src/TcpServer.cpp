@@ -0,0 +1,165 @@
+#include <W5500/TcpServer.hpp>
+
+namespace W5500 {
+
+bool TcpServer::add_socket(uint8_t socket) {
+    if (socket >= max_sockets || _slots[socket].state != SlotState::UNUSED) {
+        return false;
+    }
+    _slots[socket].state = SlotState::STOPPED;
+    return true;
+}
+
+void TcpServer::begin() {
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        if (_slots[socket].state != SlotState::UNUSED) {
+            arm(socket);
+        }
+    }
+}
+
+void TcpServer::end() {
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        if (_slots[socket].state != SlotState::UNUSED) {
+            _driver.send_socket_command(
+                socket, Registers::Socket::CommandValue::CLOSE);
+            _slots[socket].state = SlotState::STOPPED;
+        }
+    }
+}
+
+void TcpServer::arm(uint8_t socket) {
+    _driver.send_socket_command(socket,
+                                Registers::Socket::CommandValue::CLOSE);
+    _driver.set_socket_mode(socket, SocketMode::TCP);
+    _driver.set_socket_src_port(socket, _port);
+    _driver.send_socket_command(socket, Registers::Socket::CommandValue::OPEN);
+    _driver.send_socket_command(socket,
+                                Registers::Socket::CommandValue::LISTEN);
+    _driver.clear_socket_interrupt_flag(
+        socket, Registers::Socket::InterruptFlags::CONNECT);
+    _slots[socket].state = SlotState::LISTENING;
+    _stats.arms++;
+}
+
+void TcpServer::poll() {
+    using Registers::Socket::StatusValue;
+    bool any_listening = false;
+    bool running = false;
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        Slot &slot = _slots[socket];
+        if (slot.state == SlotState::UNUSED ||
+            slot.state == SlotState::STOPPED) {
+            continue;
+        }
+        running = true;
+        if (slot.state == SlotState::ACCEPTED) {
+            continue;
+        }
+
+        const StatusValue status = _driver.get_socket_status(socket);
+        switch (slot.state) {
+        case SlotState::LISTENING:
+            if (status == StatusValue::LISTEN ||
+                status == StatusValue::SYN_RECV) {
+                any_listening = true;
+            } else if (status == StatusValue::ESTABLISHED ||
+                       status == StatusValue::CLOSE_WAIT) {
+                // Clients may send everything and close before the
+                // connection is accepted, so CLOSE_WAIT counts too
+                _driver.clear_socket_interrupt_flag(
+                    socket, Registers::Socket::InterruptFlags::CONNECT);
+                slot.state = SlotState::READY;
+                slot.ready_ms = _driver.bus().millis();
+                _stats.connections++;
+            } else {
+                // The handshake failed and the socket closed
+                _stats.aborted++;
+                arm(socket);
+                any_listening = true;
+            }
+            break;
+        case SlotState::READY:
+            if (status != StatusValue::ESTABLISHED &&
+                status != StatusValue::CLOSE_WAIT) {
+                // Reset or timed out while waiting
+                _stats.aborted++;
+                arm(socket);
+                any_listening = true;
+            }
+            break;
+        case SlotState::CLOSING:
+            if (status == StatusValue::CLOSED) {
+                arm(socket);
+                any_listening = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (running && !any_listening) {
+        _stats.saturated_polls++;
+    }
+}
+
+int TcpServer::accept() {
+    int oldest = -1;
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        if (_slots[socket].state == SlotState::READY &&
+            (oldest < 0 ||
+             _slots[socket].ready_ms < _slots[oldest].ready_ms)) {
+            oldest = socket;
+        }
+    }
+    if (oldest < 0) {
+        return -1;
+    }
+
+    Slot &slot = _slots[oldest];
+    slot.state = SlotState::ACCEPTED;
+    const uint64_t latency = _driver.bus().millis() - slot.ready_ms;
+    _stats.accepted++;
+    _stats.accept_latency_total_ms += latency;
+    if (latency > _stats.accept_latency_max_ms) {
+        _stats.accept_latency_max_ms = latency;
+    }
+    return oldest;
+}
+
+void TcpServer::release(uint8_t socket, bool graceful) {
+    using Registers::Socket::StatusValue;
+    if (socket >= max_sockets ||
+        (_slots[socket].state != SlotState::ACCEPTED &&
+         _slots[socket].state != SlotState::READY)) {
+        return;
+    }
+
+    const StatusValue status = _driver.get_socket_status(socket);
+    if (graceful && (status == StatusValue::ESTABLISHED ||
+                     status == StatusValue::CLOSE_WAIT)) {
+        // poll() re-arms it once the FIN handshake completes
+        _driver.send_socket_command(
+            socket, Registers::Socket::CommandValue::DISCONNECT);
+        _slots[socket].state = SlotState::CLOSING;
+    } else {
+        arm(socket);
+    }
+}
+
+size_t TcpServer::count(SlotState state) const {
+    size_t n = 0;
+    for (uint8_t socket = 0; socket < max_sockets; socket++) {
+        if (_slots[socket].state == state) {
+            n++;
+        }
+    }
+    return n;
+}
+
+size_t TcpServer::pending() const { return count(SlotState::READY); }
+
+size_t TcpServer::listening() const { return count(SlotState::LISTENING); }
+
+} // namespace W5500
@@ -3,41 +3,32 @@
 
 namespace W5500 {
 
-bool TcpSocket::init() {
-    _driver.set_socket_mode(_sockfd, SocketMode::TCP);
-    _driver.send_socket_command(_sockfd, Registers::Socket::CommandValue::OPEN);
-    return ready();
-}
+bool TcpSocket::init() { return _tcp.init(); }
 
-bool TcpSocket::ready() {
-    Registers::Socket::StatusValue status = _driver.get_socket_status(_sockfd);
-    // Return true if the socket is open, connecting or connected.
-    return status == Registers::Socket::StatusValue::INIT        // Opened
-           || status == Registers::Socket::StatusValue::LISTEN   // Server mode
-           || status == Registers::Socket::StatusValue::SYN_SENT // Client conn
-                                                                 // in progress
-           || status == Registers::Socket::StatusValue::SYN_RECV // Server conn
-                                                                 // in progress
-           ||
-           status ==
-               Registers::Socket::StatusValue::ESTABLISHED; // Client connected
-}
+bool TcpSocket::ready() { return _tcp.ready(); }
+
+bool TcpSocket::connecting() { return _tcp.connecting(); }
 
-bool TcpSocket::connecting() {
-    return _driver.get_socket_status(_sockfd) ==
-           Registers::Socket::StatusValue::SYN_SENT;
+bool TcpSocket::connected() { return _tcp.connected(); }
+
+void TcpSocket::connect(const uint8_t ip[4], uint16_t port) {
+    _tcp.connect(ip, port);
 }
 
-bool TcpSocket::connected() {
-    return _driver.get_socket_status(_sockfd) ==
-           Registers::Socket::StatusValue::ESTABLISHED;
+bool TcpSocket::listen(uint16_t port) { return _tcp.listen(port); }
+
+void TcpSocket::send_stream(const uint8_t *data, size_t size) {
+    _tcp.send_stream(data, size);
 }
 
-void TcpSocket::connect(const uint8_t ip[4], uint16_t port) {
-    set_dest_ip(ip);
-    set_dest_port(port);
-    set_source_port(_ephemeral_port++);
-    Socket::connect();
+void TcpSocket::send_stream(StreamSource source, void *ctx) {
+    _tcp.send_stream(source, ctx);
 }
 
+StreamState TcpSocket::poll_stream() { return _tcp.poll_stream(); }
+
+void TcpSocket::cancel_stream() { _tcp.cancel_stream(); }
+
+size_t TcpSocket::stream_bytes_sent() const { return _tcp.stream_bytes_sent(); }
+
 } // namespace W5500
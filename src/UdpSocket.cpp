@@ -78,6 +78,20 @@ int UdpSocket::read(uint8_t *buffer, size_t size) {
     return read;
 }
 
+int UdpSocket::consume(ConsumeCallback callback, void *ctx,
+                       size_t max_bytes) {
+    // Stop at the end of the current datagram, rather than running on into
+    // the next one's header
+    const size_t remaining =
+        _packet_bytes_remaining > 0 ? size_t(_packet_bytes_remaining) : 0;
+    if (max_bytes > remaining) {
+        max_bytes = remaining;
+    }
+    int read = Socket::consume(callback, ctx, max_bytes);
+    _packet_bytes_remaining -= read;
+    return read;
+}
+
 void UdpSocket::flush() {
     Socket::flush();
     _packet_bytes_remaining = 0;
@@ -87,4 +101,46 @@ int UdpSocket::remaining_bytes_in_packet() { return _packet_bytes_remaining; }
 
 void UdpSocket::skip_to_packet_end() { read(nullptr, _packet_bytes_remaining); }
 
+int UdpSocket::recv_batch(uint8_t *buffer, size_t buffer_size,
+                          UdpDatagram *datagrams, size_t max_datagrams) {
+    if (_packet_bytes_remaining > 0) {
+        skip_to_packet_end();
+    }
+
+    // Pull in everything pending, or as much as fits
+    size_t size = _driver.get_rx_byte_count(_sockfd);
+    if (size < udp_header_size || max_datagrams == 0) {
+        return 0;
+    }
+    if (size > buffer_size) {
+        size = buffer_size;
+    }
+    _driver.peek(_sockfd, buffer, size);
+
+    // Split it up into datagrams, stopping at the first one that was cut off
+    size_t offset = 0;
+    size_t count = 0;
+    while (count < max_datagrams && offset + udp_header_size <= size) {
+        const uint8_t *header = &buffer[offset];
+        const uint16_t payload_size = header[6] << 8 | header[7];
+        if (offset + udp_header_size + payload_size > size) {
+            break;
+        }
+
+        UdpDatagram &datagram = datagrams[count++];
+        memcpy(datagram.source_ip, header, 4);
+        datagram.source_port = header[4] << 8 | header[5];
+        datagram.data = header + udp_header_size;
+        datagram.size = payload_size;
+        offset += udp_header_size + payload_size;
+    }
+    if (count == 0) {
+        return -1;
+    }
+
+    // Release all of it at once
+    _driver.read(_sockfd, nullptr, offset);
+    return count;
+}
+
 } // namespace W5500